@@ -90,6 +90,8 @@ int ilias_main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
                            "then use list_vscode_tasks, execute_vscode_task, query_prompts, etc.");
 
     server.setCapabilities(ToolsCapability{});
+    // docker / rsync / code commands block on popen, keep them off the IO thread
+    server.setToolExecutor(std::make_shared<ToolExecutor>(4));
 
     // Set up parameter descriptions
     server->load_config.paramsDescription = {
@@ -6,13 +6,20 @@
 #include <ilias/task/task.hpp>
 
 #include <cstddef>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <span>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace ILIAS_NAMESPACE {
 class TcpListener;
-}
+class IoContext;
+} // namespace ILIAS_NAMESPACE
 
 NEKO_BEGIN_NAMESPACE
 
@@ -38,9 +45,50 @@ private:
     friend class SseListener;
 };
 
+/**
+ * @brief Routes POST /message to the shard that owns the SSE session.
+ *
+ * Session ids carry the owning shard ("<shard>-<n>"), a POST accepted by another shard is handed over through the
+ * owner's IoContext.
+ */
+class SseShardRouter {
+public:
+    using Deliver = std::function<void(std::string id, std::string content)>;
+
+    explicit SseShardRouter(std::size_t shards) : mShards(shards) {}
+
+    auto shardCount() const noexcept -> std::size_t { return mShards.size(); }
+    /// Shard owning session `id`, npos if the id has no shard prefix.
+    static auto shardOf(std::string_view id) noexcept -> std::size_t;
+    /// Register the running shard, `deliver` is always invoked on the thread of `context`.
+    auto attach(std::size_t shard, ilias::IoContext& context, Deliver deliver) -> void;
+    auto detach(std::size_t shard) -> void;
+    /// Queue `content` for session `id` on its owning shard, false if that shard is not running.
+    auto forward(std::string_view id, std::string content) -> bool;
+
+private:
+    /// Messages waiting for a shard, drained on its thread. At most one drain is posted at a time, it only holds a
+    /// weak reference, so a shard detached meanwhile is skipped and its pending messages are freed with the inbox.
+    struct Inbox {
+        ilias::IoContext* context = nullptr;
+        Deliver deliver;
+        std::mutex mutex;
+        std::deque<std::pair<std::string, std::string>> messages; // guarded by mutex
+        bool posted = false;                                      // guarded by mutex
+    };
+
+    static auto _drain(void* inbox) -> void;
+
+    std::mutex mMutex;
+    std::vector<std::shared_ptr<Inbox>> mShards;
+};
+
 class SseListener {
 public:
     explicit SseListener(ilias::TcpListener listener);
+    /// One shard of a multi threaded server, must be created on the thread that runs `context`.
+    SseListener(ilias::TcpListener listener, std::shared_ptr<SseShardRouter> router, std::size_t shard,
+                ilias::IoContext& context);
     SseListener(SseListener&&) noexcept;
     SseListener(const SseListener&) = delete;
     ~SseListener();
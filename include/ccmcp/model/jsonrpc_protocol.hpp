@@ -6,6 +6,7 @@
 
 #include <nekoproto/jsonrpc/jsonrpc.hpp>
 
+#include <cstdint>
 #include <map>
 #include <optional>
 #include <string>
@@ -112,10 +113,21 @@ struct ReadResourceRequestParams {
     NEKO_SERIALIZER(uri, _meta)
 };
 
+/// The part of a resource a ranged resources/read returned, `nextOffset` is absent once the end is reached.
+struct ResourceRangeMeta {
+    int64_t offset;
+    int64_t length;
+    int64_t totalSize;
+    std::optional<int64_t> nextOffset;
+
+    NEKO_SERIALIZER(offset, length, totalSize, nextOffset)
+};
+
 struct ReadResourceResult {
     std::vector<std::variant<TextResourceContents, BlobResourceContents>> contents;
+    std::optional<ResourceRangeMeta> _meta;
 
-    NEKO_SERIALIZER(contents)
+    NEKO_SERIALIZER(contents, _meta)
 };
 
 struct SubscribeRequestParams {
@@ -301,6 +313,15 @@ struct ListRootsResult {
     NEKO_SERIALIZER(roots, _meta)
 };
 
+template <typename ParamsT>
+struct JsonRpcNotification {
+    std::string jsonrpc = "2.0";
+    std::string method;
+    ParamsT params;
+
+    NEKO_SERIALIZER(jsonrpc, method, params)
+};
+
 struct CancelledNotificationParams {
     std::variant<int, std::string> requestId;
     std::optional<std::string> reason;
@@ -311,6 +332,15 @@ struct CancelledNotificationParams {
 namespace detail {
 NEKO_USE_NAMESPACE
 
+template <typename T>
+auto serialize_json(const T& value) -> std::string {
+    std::vector<char> buffer;
+    JsonSerializer::OutputSerializer out(buffer);
+    out(value);
+    out.end();
+    return std::string(buffer.begin(), buffer.end());
+}
+
 struct McpJsonRpcMethods {
     RpcMethodSpec<InitializeResult(InitializeRequestParams), rpc_name<"initialize">,
                   rpc_args<"initialize_request_params">, rpc_desc<"Initialize the connection">>
@@ -318,10 +348,11 @@ struct McpJsonRpcMethods {
     RpcMethodSpec<void(EmptyRequestParams), rpc_name<"notifications/initialized">,
                   rpc_desc<"Notification that the client has initialized">, rpc_notification>
         initialized;
-    RpcMethodSpec<ListResourcesResult(EmptyRequestParams), rpc_name<"resources/list">, rpc_desc<"List resources">>
+    RpcMethodSpec<ListResourcesResult(PaginatedRequest), rpc_name<"resources/list">, rpc_desc<"List resources">,
+                  rpc_args<"paginated_request">>
         resourcesList;
-    RpcMethodSpec<ListResourceTemplatesResult(EmptyRequestParams), rpc_name<"resources/templates/list">,
-                  rpc_desc<"List resource templates">>
+    RpcMethodSpec<ListResourceTemplatesResult(PaginatedRequest), rpc_name<"resources/templates/list">,
+                  rpc_desc<"List resource templates">, rpc_args<"paginated_request">>
         resourcesTemplatesList;
     RpcMethodSpec<ReadResourceResult(ReadResourceRequestParams), rpc_name<"resources/read">,
                   rpc_args<"read_resource_request_params">, rpc_desc<"Read a resource">>
@@ -342,7 +373,8 @@ struct McpJsonRpcMethods {
                   rpc_args<"resource_updated_notification_params">,
                   rpc_desc<"Notification that a resource has been updated">>
         resourcesUpdated;
-    RpcMethodSpec<ListPromptsResult(EmptyRequestParams), rpc_name<"prompts/list">, rpc_desc<"Get the list of prompts">>
+    RpcMethodSpec<ListPromptsResult(PaginatedRequest), rpc_name<"prompts/list">, rpc_desc<"Get the list of prompts">,
+                  rpc_args<"paginated_request">>
         promptsList;
     RpcMethodSpec<GetPromptResult(GetPromptRequestParams), rpc_name<"prompts/get">, rpc_desc<"Get a prompt">>
         promptsGet;
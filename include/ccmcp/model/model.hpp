@@ -5,12 +5,18 @@
 #include "capabilities.hpp"
 
 #include <ilias/io/error.hpp>
+#include <ilias/task.hpp>
 #include <nekoproto/global/reflect.hpp>
 #include <nekoproto/serialization/json/schema.hpp>
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -100,6 +106,178 @@ protected:
 };
 } // namespace traits
 
+/**
+ * @brief Descriptions of the parameters of a tool, every assignment rebuilds its input schema.
+ */
+class ParamsDescription {
+public:
+    using MapT           = std::map<std::string_view, std::string>;
+    using SchemaFunction = auto (*)() -> const std::shared_ptr<JsonSchema>&;
+
+    /// Description of one parameter, assigning it rebuilds the schema.
+    class Entry {
+    public:
+        auto operator=(std::string description) -> Entry& {
+            mOwner.mDescriptions[mParam] = std::move(description);
+            mOwner._rebuild();
+            return *this;
+        }
+        operator std::string_view() const noexcept {
+            auto it = mOwner.mDescriptions.find(mParam);
+            return it == mOwner.mDescriptions.end() ? std::string_view{} : std::string_view(it->second);
+        }
+
+    private:
+        friend class ParamsDescription;
+        Entry(ParamsDescription& owner, std::string_view param) noexcept : mOwner(owner), mParam(param) {}
+
+        ParamsDescription& mOwner;
+        std::string_view mParam;
+    };
+
+    ParamsDescription() = default;
+    ParamsDescription(const MapT& descriptions) : mDescriptions(descriptions) {}
+    ParamsDescription(std::initializer_list<MapT::value_type> descriptions) : mDescriptions(descriptions) {}
+    /// A copy is not published, it does not take over the change callback.
+    ParamsDescription(const ParamsDescription& other)
+        : mDescriptions(other.mDescriptions), mBase(other.mBase), mSchema(other.mSchema) {}
+
+    /// Takes the descriptions of `other`, the base schema stays the one of this tool.
+    auto operator=(const ParamsDescription& other) -> ParamsDescription& { return *this = other.mDescriptions; }
+    auto operator=(const MapT& descriptions) -> ParamsDescription& {
+        mDescriptions = descriptions;
+        _rebuild();
+        return *this;
+    }
+    auto operator=(std::initializer_list<MapT::value_type> descriptions) -> ParamsDescription& {
+        mDescriptions = descriptions;
+        _rebuild();
+        return *this;
+    }
+    auto operator[](std::string_view param) -> Entry { return Entry(*this, param); }
+
+    auto begin() const noexcept { return mDescriptions.begin(); }
+    auto end() const noexcept { return mDescriptions.end(); }
+    auto size() const noexcept { return mDescriptions.size(); }
+    auto empty() const noexcept { return mDescriptions.empty(); }
+    auto map() const noexcept -> const MapT& { return mDescriptions; }
+
+    /// Set the schema the descriptions are laid over, by the tool owning them.
+    auto setBaseSchema(SchemaFunction base) -> void {
+        mBase = base;
+        _rebuild();
+    }
+    /// The base schema with the descriptions, null without a base schema.
+    auto schema() const -> std::shared_ptr<JsonSchema> {
+        if (mSchema) {
+            return mSchema;
+        }
+        return mBase != nullptr ? mBase() : nullptr;
+    }
+
+    /// Called after every change, set by the server publishing the tool.
+    auto setOnChange(std::function<void()> onChange) -> void { mOnChange = std::move(onChange); }
+
+private:
+    auto _rebuild() -> void {
+        _rebuild_schema();
+        if (mOnChange) {
+            mOnChange();
+        }
+    }
+    /// Without descriptions the shared base schema is used as is, no copy is kept.
+    auto _rebuild_schema() -> void {
+        mSchema.reset();
+        if (mBase == nullptr || mDescriptions.empty()) {
+            return;
+        }
+        auto schema = std::make_shared<JsonSchema>(*mBase());
+        if (!schema->properties) {
+            schema->properties = std::map<std::string, JsonSchema>();
+        }
+        for (const auto& [param, description] : mDescriptions) {
+            (*schema->properties)[std::string(param)].description = description;
+        }
+        mSchema = std::move(schema);
+    }
+
+    MapT mDescriptions;
+    SchemaFunction mBase = nullptr;
+    std::shared_ptr<JsonSchema> mSchema;
+    std::function<void()> mOnChange;
+};
+
+/// Per tool execution settings, unset fields follow the server defaults.
+struct ToolOptions {
+    /// Run a synchronous tool on the server's ToolExecutor instead of the IoContext thread.
+    std::optional<bool> offload;
+    /// Calls of this tool running at the same time, 0 means unlimited.
+    std::size_t maxConcurrency = 0;
+    /// Calls waiting for a free slot once maxConcurrency is reached, further calls are rejected.
+    std::size_t maxQueue = 0;
+    /// How long results stay in the server result cache. Unset uses the server default for tools annotated read-only
+    /// or idempotent, zero never caches.
+    std::optional<std::chrono::milliseconds> cacheTtl;
+    /// Identical calls (same canonical arguments) made while one is running share its execution and result.
+    bool coalesce = false;
+    /// Deadline of each call, a request may shorten it with `_meta.timeout` (milliseconds). Synchronous tools see it
+    /// through this_tool::stop_requested().
+    std::optional<std::chrono::milliseconds> timeout;
+};
+
+/// One step of a streaming tool, partial content is appended to the final result in order.
+template <typename T>
+struct ToolUpdate {
+    std::optional<T> content;
+    /// Reported to the client as notifications/progress when the request carries a progress token.
+    std::optional<float> progress;
+    std::optional<float> total;
+};
+
+/// Return type of a streaming tool, the server sends the aggregated CallToolResult once the generator is exhausted.
+template <typename T>
+using ToolStream = ILIAS_NAMESPACE::Generator<ToolUpdate<T>>;
+
+namespace traits {
+template <typename T>
+struct ToolStreamTraits : std::false_type {};
+template <typename T>
+struct ToolStreamTraits<ToolStream<T>> : std::true_type {
+    using ContentT = T;
+};
+template <typename T>
+constexpr bool is_tool_stream = ToolStreamTraits<T>::value;
+} // namespace traits
+
+/// Description of a tool parameter attached at compile time, see ToolFunction and ToolFunctionS.
+template <NEKO_NAMESPACE::ConstexprString Param, NEKO_NAMESPACE::ConstexprString Description>
+struct ParamDoc {
+    constexpr static std::string_view param       = Param.view();
+    constexpr static std::string_view description = Description.view();
+};
+
+namespace detail {
+/**
+ * @brief Input schema of `ParamsT`, generated once per (ParamsT, Docs...) type and shared by its tools.
+ */
+template <typename ParamsT, typename... Docs>
+auto input_schema() -> const std::shared_ptr<JsonSchema>& {
+    static const std::shared_ptr<JsonSchema> schema = []() {
+        JsonSchema inputSchema;
+        inputSchema.properties = std::map<std::string, JsonSchema>();
+        if constexpr (!std::is_void_v<ParamsT>) {
+            (((*inputSchema.properties)[std::string(Docs::param)].description = std::string(Docs::description)), ...);
+            generate_schema<ParamsT>(ParamsT{}, inputSchema);
+        } else {
+            static_assert(sizeof...(Docs) == 0, "a tool without parameters cannot describe them");
+            inputSchema.type = "object";
+        }
+        return std::make_shared<JsonSchema>(std::move(inputSchema));
+    }();
+    return schema;
+}
+} // namespace detail
+
 template <typename T>
 struct DynamicToolFunction : traits::ToolFunctionTraits<T> {
     using TypeTraits   = traits::ToolFunctionTraits<T>;
@@ -108,62 +286,86 @@ struct DynamicToolFunction : traits::ToolFunctionTraits<T> {
     using FunctionT    = TypeTraits::FunctionT;
     using FunctionTRaw = TypeTraits::FunctionTRaw;
 
-    DynamicToolFunction(std::string_view name, std::string_view description) : name(name), description(description) {}
+    DynamicToolFunction(std::string_view name, std::string_view description)
+        : DynamicToolFunction(name, description, &detail::input_schema<ParamsT>) {}
 
-    auto tool() -> Tool {
+    /// Only reads the schema, which is rebuilt whenever paramsDescription changes.
+    auto tool() const -> Tool {
         Tool tl;
         tl.name        = std::string(name);
         tl.description = description;
-        JsonSchema inputSchema;
-        if constexpr (!std::is_void_v<ParamsT>) {
-            inputSchema.properties = std::map<std::string, JsonSchema>();
-            for (const auto& [pname, desc] : paramsDescription) {
-                (*inputSchema.properties)[std::string(pname)].description = desc;
-            }
-            generate_schema<ParamsT>(ParamsT{}, inputSchema);
-        } else {
-            inputSchema.type       = "object";
-            inputSchema.properties = std::map<std::string, JsonSchema>();
-        }
-        tl.inputSchema = std::make_shared<JsonSchema>(std::move(inputSchema));
+        tl.inputSchema = paramsDescription.schema();
+        tl.annotations = annotations;
         return tl;
     }
 
     auto& operator=(FunctionTRaw func) {
+        mBlocking = std::make_shared<FunctionTRaw>(std::move(func));
         if constexpr (std::is_void_v<ParamsT>) {
-            this->function = [func = std::move(func)]() mutable -> ILIAS_NAMESPACE::IoTask<ReturnT> {
-                co_return func();
-            };
+            this->function = [func = mBlocking]() mutable -> ILIAS_NAMESPACE::IoTask<ReturnT> { co_return (*func)(); };
         } else {
-            this->function = [func = std::move(func)](ParamsT params) mutable -> ILIAS_NAMESPACE::IoTask<ReturnT> {
-                co_return func(std::move(params));
+            this->function = [func = mBlocking](ParamsT params) mutable -> ILIAS_NAMESPACE::IoTask<ReturnT> {
+                co_return (*func)(std::move(params));
             };
         }
         return *this;
     }
     auto& operator=(FunctionT func) {
+        mBlocking.reset();
         this->function = std::move(func);
         return *this;
     }
     operator bool() const { return this->function != nullptr; }
 
+    /// True if the tool was given as a synchronous function, which can be run with callBlocking().
+    auto isBlocking() const noexcept -> bool { return mBlocking != nullptr; }
+    template <typename... Args>
+    auto callBlocking(Args&&... args) const -> ReturnT {
+        return (*mBlocking)(std::forward<Args>(args)...);
+    }
+    /// The synchronous function, for callers that may run it after the tool is gone.
+    auto blockingFunction() const noexcept -> const std::shared_ptr<FunctionTRaw>& { return mBlocking; }
+
     std::string name;
-    std::map<std::string_view, std::string> paramsDescription;
+    ParamsDescription paramsDescription;
     std::string description;
+    std::optional<ToolAnnotations> annotations;
+    ToolOptions options;
+
+protected:
+    /// `schema` is the schema without the runtime paramsDescription, ToolFunction passes one carrying its ParamDoc
+    /// descriptions.
+    DynamicToolFunction(std::string_view name, std::string_view description, ParamsDescription::SchemaFunction schema)
+        : name(name), description(description) {
+        paramsDescription.setBaseSchema(schema);
+    }
+
+private:
+    std::shared_ptr<FunctionTRaw> mBlocking;
 };
 
-template <typename T, NEKO_NAMESPACE::ConstexprString FuncName>
+/**
+ * @brief Tool declared as a member of a ToolFunctions struct, `Docs` describe its parameters.
+ * @code
+ * ToolFunction<Result(Params), "read_file", ParamDoc<"path", "file to read">> readFile{"Read a file"};
+ * @endcode
+ */
+template <typename T, NEKO_NAMESPACE::ConstexprString FuncName, typename... Docs>
 struct ToolFunction : DynamicToolFunction<T> {
-    ToolFunction(std::string_view description) : DynamicToolFunction<T>(FuncName.view(), description) {}
+    ToolFunction(std::string_view description)
+        : DynamicToolFunction<T>(FuncName.view(), description,
+                                 &detail::input_schema<typename DynamicToolFunction<T>::ParamsT, Docs...>) {}
     using DynamicToolFunction<T>::operator=;
     constexpr static std::string_view name = FuncName.view();
 };
 
-template <auto StaticFunction, NEKO_NAMESPACE::ConstexprString FuncName = "">
+template <auto StaticFunction, NEKO_NAMESPACE::ConstexprString FuncName = "", typename... Docs>
 struct ToolFunctionS
     : DynamicToolFunction<typename NEKO_NAMESPACE::detail::function_traits<decltype(StaticFunction)>::function_type> {
     using FunctionType = typename NEKO_NAMESPACE::detail::function_traits<decltype(StaticFunction)>::function_type;
-    ToolFunctionS(std::string_view description) : DynamicToolFunction<FunctionType>(name, description) {
+    ToolFunctionS(std::string_view description)
+        : DynamicToolFunction<FunctionType>(
+              name, description, &detail::input_schema<typename DynamicToolFunction<FunctionType>::ParamsT, Docs...>) {
         DynamicToolFunction<FunctionType>::operator=(std::function(StaticFunction));
     }
     constexpr static std::string_view name =
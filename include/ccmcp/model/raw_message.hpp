@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+CCMCP_BN
+namespace detail {
+/// Index of the first non whitespace character at or after `pos`.
+auto json_skip_ws(std::string_view json, std::size_t pos) noexcept -> std::size_t;
+/// Index just past the JSON value starting at `pos`, or npos if it is malformed. Only the structure is checked.
+auto json_skip_value(std::string_view json, std::size_t pos) noexcept -> std::size_t;
+/// Raw slice of the member `key` of the JSON object `object`.
+auto json_member(std::string_view object, std::string_view key) noexcept -> std::optional<std::string_view>;
+/// Raw slices of every member of the JSON object `object`, in document order.
+auto json_members(std::string_view object) -> std::optional<std::vector<std::pair<std::string_view, std::string_view>>>;
+/// Raw slices of every element of the JSON array `array`.
+auto json_elements(std::string_view array) -> std::optional<std::vector<std::string_view>>;
+/// Content of a JSON string token without its quotes, nullopt if `raw` is not a string or contains escapes.
+auto json_plain_string(std::string_view raw) noexcept -> std::optional<std::string_view>;
+/// Append `text` to `out` as a quoted JSON string.
+auto json_append_string(std::string& out, std::string_view text) -> void;
+/// Append `value` without insignificant whitespace and with object members sorted by key, so equal documents give
+/// equal strings. False if `value` is malformed.
+auto json_append_canonical(std::string& out, std::string_view value) -> bool;
+} // namespace detail
+
+/**
+ * @brief Envelope of one JSON-RPC message, every field is a slice of the received buffer.
+ */
+struct RawMessage {
+    /// raw id token (number or quoted string), empty for notifications
+    std::string_view id;
+    /// method name, empty for responses or when the name contains escapes
+    std::string_view method;
+    /// raw params value, empty if absent
+    std::string_view params;
+
+    auto isNotification() const noexcept -> bool { return id.empty(); }
+
+    static auto parse(std::string_view json) noexcept -> std::optional<RawMessage>;
+};
+
+namespace detail {
+/// {"jsonrpc":"2.0","id":<id>,"result":<result>}
+auto make_raw_result(std::string_view id, std::string_view result) -> std::string;
+/// {"jsonrpc":"2.0","id":<id>,"error":{"code":<code>,"message":<message>}}
+auto make_raw_error(std::string_view id, int code, std::string_view message) -> std::string;
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+CCMCP_BN
+namespace detail {
+constexpr auto base64_encoded_size(std::size_t size) noexcept -> std::size_t { return (size + 2) / 3 * 4; }
+
+/// Write `data` as padded base64 to `out`, which must hold base64_encoded_size(data.size()) characters. Uses AVX2 or
+/// SSSE3 when the CPU has them, picked once at runtime.
+auto base64_encode(std::span<const std::byte> data, char* out) noexcept -> void;
+/// Portable version of base64_encode(), the SIMD paths fall back to it for their tail.
+auto base64_encode_scalar(std::span<const std::byte> data, char* out) noexcept -> void;
+/// Append `data` to `out` as base64, growing `out` once.
+auto base64_append(std::string& out, std::span<const std::byte> data) -> void;
+/// "avx2", "ssse3" or "scalar", the encoder base64_encode() runs.
+auto base64_implementation() noexcept -> std::string_view;
+} // namespace detail
+CCMCP_EN
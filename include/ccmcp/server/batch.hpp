@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/server/session.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief Responses of one JSON-RPC batch, joined in request order once every slot is settled.
+ *
+ * Notifications and cancelled requests leave their slot empty, a batch without any response posts nothing.
+ */
+class BatchReply {
+public:
+    BatchReply(std::weak_ptr<McpSession> session, std::size_t count)
+        : mSession(std::move(session)), mSlots(count), mRemaining(count) {}
+
+    auto set(std::size_t index, std::string response) -> void;
+    auto skip(std::size_t index) -> void;
+
+private:
+    struct Slot {
+        bool settled = false;
+        std::optional<std::string> response;
+    };
+
+    auto _settle(std::size_t index, std::optional<std::string> response) -> void;
+
+    std::weak_ptr<McpSession> mSession;
+    std::vector<Slot> mSlots;
+    std::size_t mRemaining;
+};
+
+/// Where the response of one request goes, straight to its session or into its slot of a batch.
+struct Responder {
+    std::weak_ptr<McpSession> session;
+    std::shared_ptr<BatchReply> batch;
+    std::size_t index = 0;
+
+    auto reply(std::string message) const -> void;
+    /// The request ends without a response.
+    auto drop() const -> void;
+};
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/model/base.hpp"
+#include "ccmcp/model/jsonrpc_protocol.hpp"
+#include "ccmcp/model/raw_message.hpp"
+
+#include <nekoproto/global/reflect.hpp>
+
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+CCMCP_BN
+namespace detail {
+/// Types make_content() turns into a TextContent.
+template <typename T>
+concept TextContentValue = std::is_arithmetic_v<T> || std::is_same_v<T, std::string> ||
+                           std::is_same_v<T, std::string_view> || std::is_same_v<T, std::u8string> ||
+                           std::is_same_v<T, const char*>;
+
+template <typename T>
+concept ContentValue =
+    std::is_same_v<T, TextContent> || std::is_same_v<T, ImageContent> || std::is_same_v<T, EmbeddedResource>;
+
+/**
+ * @brief Call `func` with every content item of a tool return value.
+ *
+ * Reflected structs give one item per field, ranges (other than strings) one per element.
+ */
+template <typename T, typename FuncT>
+auto for_each_content_item(T& value, FuncT&& func) -> void {
+    using U = std::remove_cvref_t<T>;
+    if constexpr (ContentValue<U>) {
+        func(value);
+    } else if constexpr (NEKO_NAMESPACE::detail::has_values_meta<U>) {
+        NEKO_NAMESPACE::Reflect<U>::forEach(value, func);
+    } else if constexpr (requires { std::begin(value); } && !TextContentValue<U> &&
+                         !std::is_same_v<U, std::u8string_view>) {
+        for (auto& item : value) {
+            func(item);
+        }
+    } else {
+        func(value);
+    }
+}
+
+/// Append one content item as JSON, text items are written directly instead of through a TextContent.
+template <typename T>
+auto append_content_item(std::string& out, const T& value) -> void {
+    if constexpr (TextContentValue<T>) {
+        out.append(R"({"type":"text","text":)");
+        if constexpr (std::is_arithmetic_v<T>) {
+            json_append_string(out, std::to_string(value));
+        } else if constexpr (std::is_same_v<T, std::u8string>) {
+            json_append_string(out, std::string_view(reinterpret_cast<const char*>(value.data()), value.size()));
+        } else {
+            json_append_string(out, std::string_view(value));
+        }
+        out.push_back('}');
+    } else {
+        out.append(serialize_json(make_content(value)));
+    }
+}
+
+/// Append the `content` array of a CallToolResult for `value` to `out`, without building the CallToolResult.
+template <typename T>
+auto append_content_json(std::string& out, T& value) -> void {
+    out.push_back('[');
+    bool first = true;
+    for_each_content_item(value, [&](const auto& item) {
+        if (!first) {
+            out.push_back(',');
+        }
+        first = false;
+        append_content_item(out, item);
+    });
+    out.push_back(']');
+}
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/model/base.hpp"
+#include "ccmcp/server/file_resource.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief The files under a directory root, listed as resources and read through the file:///{path} template.
+ *
+ * Directories are scanned lazily and listed depth first, sorted by name, so a page resumes after the last path.
+ */
+class DirectoryIndex {
+public:
+    DirectoryIndex(std::filesystem::path root, FileResourceOptions options);
+
+    auto root() const noexcept -> const std::filesystem::path& { return mRoot; }
+    /// file:// URI prefix of every resource under the root, with a trailing slash.
+    auto uriPrefix() const noexcept -> std::string_view { return mUriPrefix; }
+
+    /// Append the resources following the file at relative path `after` (from the first file if it is empty) until
+    /// `out` holds `limit` entries, 0 for no limit. `last` is set to the relative path of the last appended file.
+    /// Returns true if the walk stopped on a file that did not fit.
+    auto list(std::string_view after, std::size_t limit, std::vector<Resource>& out, std::string& last) -> bool;
+    /// The file `uri` names, nullopt if it is not a file below the root.
+    auto resolve(std::string_view uri) const -> std::optional<LocalFileResource>;
+
+private:
+    struct Node {
+        std::string name;
+        bool directory = false;
+        /// stat results, the size of a file is valid for `mtime`, the mtime of a directory is the one it was scanned at
+        std::optional<std::uintmax_t> size;
+        std::optional<std::filesystem::file_time_type> mtime;
+        bool scanned = false;
+        std::vector<std::unique_ptr<Node>> children; // sorted by name
+    };
+
+    auto _scan(Node& dir, const std::filesystem::path& path) -> void;
+    auto _list(Node& dir, std::string& relative, std::span<const std::string_view> after, std::size_t limit,
+               std::vector<Resource>& out, std::string& last) -> bool;
+    auto _resource(Node& file, const std::string& relative) -> Resource;
+
+    std::filesystem::path mRoot;
+    std::string mUriPrefix;
+    FileResourceOptions mOptions;
+    std::mutex mMutex;
+    Node mTree;
+};
+} // namespace detail
+CCMCP_EN
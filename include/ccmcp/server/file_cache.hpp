@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief LRU cache of local file resource payloads, keyed by path.
+ *
+ * Entries are checked with inotify on Linux, by modification time and size elsewhere.
+ */
+class FileContentCache {
+public:
+    FileContentCache() = default;
+    FileContentCache(const FileContentCache&)            = delete;
+    FileContentCache& operator=(const FileContentCache&) = delete;
+    ~FileContentCache();
+
+    /// Bytes the cache may hold, 0 disables it and drops every entry.
+    auto setCapacity(std::size_t bytes) -> void;
+    auto capacity() const noexcept -> std::size_t { return mCapacity; }
+    auto enabled() const noexcept -> bool { return mCapacity != 0; }
+
+    /// Payload of `path`, from the cache or produced by `read()`. A null payload from `read()` (the file could not
+    /// be read) is returned as is and not cached.
+    template <typename ReadT>
+    auto get(const std::filesystem::path& path, ReadT&& read) -> std::shared_ptr<const std::string> {
+        auto key = path.string();
+        if (auto payload = _find(key); payload) {
+            return payload;
+        }
+        // Watched and stamped before the read, a change made while reading is never mistaken for the cached state.
+        const int watch = _watch(key);
+        auto stamp      = _stamp(key);
+        auto payload    = std::forward<ReadT>(read)();
+        if (payload && stamp) {
+            _insert(std::move(key), payload, *stamp, watch);
+        } else {
+            _unwatch(watch);
+        }
+        return payload;
+    }
+    /// Drop the payload of `path`.
+    auto invalidate(std::string_view path) -> bool;
+    auto clear() -> void;
+
+    auto size() const noexcept -> std::size_t { return mEntries.size(); }
+    auto bytes() const noexcept -> std::size_t { return mBytes; }
+    auto hits() const noexcept -> uint64_t { return mHits; }
+    auto misses() const noexcept -> uint64_t { return mMisses; }
+
+private:
+    struct Stamp {
+        std::filesystem::file_time_type mtime;
+        std::uintmax_t size = 0;
+
+        auto operator==(const Stamp&) const -> bool = default;
+    };
+    struct Entry {
+        std::string path;
+        std::shared_ptr<const std::string> payload;
+        Stamp stamp;
+        /// inotify watch descriptor, -1 if the stamp has to be checked on every hit
+        int watch = -1;
+
+        auto cost() const noexcept -> std::size_t { return path.size() + payload->size() + sizeof(Entry); }
+    };
+    using List = std::list<Entry>;
+
+    auto _find(const std::string& path) -> std::shared_ptr<const std::string>;
+    auto _insert(std::string path, std::shared_ptr<const std::string> payload, const Stamp& stamp, int watch) -> void;
+    auto _watch(const std::string& path) -> int;
+    auto _unwatch(int watch) -> void;
+    auto _poll_events() -> void;
+    static auto _stamp(const std::string& path) -> std::optional<Stamp>;
+    auto _erase(List::iterator it) -> void;
+    auto _evict() -> void;
+
+    List mEntries; // most recently used first
+    std::unordered_map<std::string_view, List::iterator> mIndex;
+    /// inotify watch descriptor -> watched path, paths may be watched before they have an entry
+    std::unordered_map<int, std::string> mWatches;
+    int mNotify           = -1;
+    bool mNotifyFailed    = false;
+    std::size_t mCapacity = 0;
+    std::size_t mBytes    = 0;
+    uint64_t mHits        = 0;
+    uint64_t mMisses      = 0;
+};
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/model/base.hpp"
+#include "ccmcp/model/jsonrpc_protocol.hpp"
+#include "ccmcp/server/file_cache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <variant>
+
+CCMCP_BN
+using ResourceContents = std::variant<TextResourceContents, BlobResourceContents>;
+
+struct FileResourceOptions {
+    /// Reads of a larger file are answered with an error content instead of the file, a ranged read returns at most
+    /// this many bytes of a file of any size.
+    std::uintmax_t maxSize = 16 * 1024 * 1024;
+    /// Map the file instead of reading it, which saves a copy of every read. On POSIX a file truncated while it is
+    /// being sent raises SIGBUS and ends the process, so only for files that are never rewritten in place.
+    bool mapped = false;
+};
+
+namespace detail {
+/**
+ * @brief Part of a file asked for by resources/read.
+ *
+ * Given as `"_meta":{"offset":N,"length":M}` in the request or as a `#bytes=START-END`, `#bytes=START-` or
+ * `#bytes=-LENGTH` suffix of the URI, END is inclusive as in an HTTP Range header.
+ */
+struct ByteRange {
+    std::uintmax_t offset = 0;
+    /// Up to the end of the file if unset.
+    std::optional<std::uintmax_t> length;
+    /// The last `length` bytes of the file, `offset` is ignored.
+    bool fromEnd = false;
+
+    /// Offset and length of the range in a file of `size` bytes, cut to the file and to `maxLength` bytes.
+    auto resolve(std::uintmax_t size, std::uintmax_t maxLength) const noexcept
+        -> std::pair<std::uintmax_t, std::uintmax_t>;
+};
+
+/// Split a `#bytes=...` suffix off `uri`, the URI is returned unchanged without a range if there is none.
+auto split_byte_range(std::string_view uri) noexcept -> std::pair<std::string_view, std::optional<ByteRange>>;
+
+/**
+ * @brief Read-only view of a whole file or of a part of it, mapped or read into memory.
+ *
+ * A read copy does not see later writes, a file that shrank in between gives a shorter view. Windows always maps.
+ */
+class MappedFile {
+public:
+    MappedFile() noexcept = default;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    /// Fails with std::errc::file_too_large if the file is larger than `maxSize`. The file is mapped if `map` is set,
+    /// see FileResourceOptions::mapped.
+    static auto open(const std::filesystem::path& path, std::error_code& ec, std::uintmax_t maxSize = UINTMAX_MAX,
+                     bool map = false) -> MappedFile;
+    /// The part of the file `range` selects, at most `maxLength` bytes of it, and up to `lookahead` bytes after it.
+    static auto open(const std::filesystem::path& path, std::error_code& ec, const ByteRange& range,
+                     std::uintmax_t maxLength, std::size_t lookahead = 0, bool map = false) -> MappedFile;
+
+    /// Offset of the view in the file and size of the whole file.
+    auto offset() const noexcept -> std::uintmax_t { return mOffset; }
+    auto fileSize() const noexcept -> std::uintmax_t { return mFileSize; }
+    auto size() const noexcept -> std::size_t { return mSize; }
+    auto view() const noexcept -> std::string_view { return {static_cast<const char*>(mData), mSize}; }
+    auto bytes() const noexcept -> std::span<const std::byte> { return {static_cast<const std::byte*>(mData), mSize}; }
+    /// The mapped bytes right after view().
+    auto lookahead() const noexcept -> std::string_view {
+        return {static_cast<const char*>(mData) + mSize, mLookahead};
+    }
+
+private:
+    static auto _open(const std::filesystem::path& path, std::error_code& ec, const ByteRange* range,
+                      std::uintmax_t limit, std::size_t lookahead, bool map) -> MappedFile;
+    auto _unmap() noexcept -> void;
+
+    const void* mBase        = nullptr;
+    std::size_t mMapSize     = 0;
+    std::unique_ptr<char[]> mBuffer;
+    const void* mData        = nullptr;
+    std::size_t mSize        = 0;
+    std::size_t mLookahead   = 0;
+    std::uintmax_t mOffset   = 0;
+    std::uintmax_t mFileSize = 0;
+};
+
+/// A resource served from a local file, its contents are read on every resources/read.
+struct LocalFileResource {
+    std::filesystem::path path;
+    std::string mimeType;
+    std::uintmax_t maxSize = FileResourceOptions{}.maxSize;
+    bool mapped            = FileResourceOptions{}.mapped;
+
+    auto isText() const noexcept -> bool;
+};
+
+/// MIME type guessed from the extension of `path`, application/octet-stream if unknown.
+auto file_mime_type(const std::filesystem::path& path) -> std::string;
+/// Append the resources/read result of `file` ({"contents":[...]}) to `out`, errors are reported as a text content.
+auto append_file_resource_result(std::string& out, const LocalFileResource& file, std::string_view uri,
+                                 FileContentCache* cache = nullptr) -> void;
+auto read_file_resource(const LocalFileResource& file, const std::string& uri, FileContentCache* cache = nullptr)
+    -> ResourceContents;
+/// Like append_file_resource_result() for the part of the file `range` selects, its position is given in `_meta`. A
+/// text range never splits a UTF-8 sequence.
+auto append_file_range_result(std::string& out, const LocalFileResource& file, std::string_view uri,
+                              const ByteRange& range) -> void;
+auto read_file_range(const LocalFileResource& file, const std::string& uri, const ByteRange& range)
+    -> ReadResourceResult;
+auto createResourceContentsFromFile(const std::filesystem::path& path, const std::string& uri,
+                                    std::uintmax_t maxSize = FileResourceOptions{}.maxSize) -> ResourceContents;
+} // namespace detail
+CCMCP_EN
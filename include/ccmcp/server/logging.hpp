@@ -0,0 +1,136 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/server/post_guard.hpp"
+#include "ccmcp/server/session.hpp"
+
+#include <fmt/format.h>
+#include <ilias/io/context.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+CCMCP_BN
+/// Syslog severities used by logging/setLevel and notifications/message, in increasing order.
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Notice,
+    Warning,
+    Error,
+    Critical,
+    Alert,
+    Emergency,
+    /// nothing is forwarded
+    Off,
+};
+
+auto log_level_from_string(std::string_view name) noexcept -> std::optional<LogLevel>;
+auto log_level_name(LogLevel level) noexcept -> std::string_view;
+
+struct LogOptions {
+    /// Records buffered between the producers and the IoContext, rounded up to a power of two.
+    std::size_t capacity = 1024;
+    /// Records forwarded per second over all loggers, 0 means unlimited. Records over the limit are dropped.
+    uint32_t maxPerSecond = 200;
+    /// Forward one of every `sampleEvery` records below LogLevel::Warning.
+    uint32_t sampleEvery = 1;
+};
+
+namespace detail {
+struct LogRecord {
+    LogLevel level = LogLevel::Debug;
+    std::string logger;
+    std::string text;
+};
+
+/**
+ * @brief Bounded lock-free queue of log records, any thread may push, the IoContext thread pops.
+ */
+class LogRing {
+public:
+    explicit LogRing(std::size_t capacity);
+
+    /// Move `record` into the ring, false if it is full.
+    auto tryPush(LogRecord& record) noexcept -> bool;
+    auto tryPop(LogRecord& record) noexcept -> bool;
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        LogRecord record;
+    };
+
+    std::unique_ptr<Cell[]> mCells;
+    std::size_t mMask;
+    alignas(64) std::atomic<std::size_t> mEnqueue{0};
+    alignas(64) std::atomic<std::size_t> mDequeue{0};
+};
+} // namespace detail
+
+/**
+ * @brief Forwards server log records to the clients as notifications/message.
+ *
+ * A record below every session level, sampled out or over the rate limit is dropped before it is formatted.
+ */
+class LogPipeline {
+public:
+    explicit LogPipeline(ILIAS_NAMESPACE::IoContext& context, const LogOptions& options = {});
+    LogPipeline(const LogPipeline&)            = delete;
+    LogPipeline& operator=(const LogPipeline&) = delete;
+
+    /// True if some session wants records of `level`, a single relaxed load.
+    auto enabled(LogLevel level) const noexcept -> bool {
+        return level >= mThreshold.load(std::memory_order_relaxed) && level != LogLevel::Off;
+    }
+
+    /// Thread safe. The arguments are only formatted if the record is going to be forwarded.
+    template <typename... Args>
+    auto log(LogLevel level, std::string_view logger, fmt::format_string<Args...> format, Args&&... args) -> void {
+        if (!enabled(level) || !_admit(level)) {
+            return;
+        }
+        _push(level, logger, fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    /// Change the rate limit and sampling, the ring capacity is fixed at construction.
+    auto setLimits(uint32_t maxPerSecond, uint32_t sampleEvery) noexcept -> void;
+    /// logging/setLevel of `session`, IoContext thread only.
+    auto setLevel(const std::shared_ptr<detail::McpSession>& session, LogLevel level) -> void;
+    /// Records rejected by the rate limit or because the ring was full.
+    auto dropped() const noexcept -> uint64_t { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Subscriber {
+        std::weak_ptr<detail::McpSession> session;
+        LogLevel level;
+    };
+
+    auto _admit(LogLevel level) noexcept -> bool;
+    auto _push(LogLevel level, std::string_view logger, std::string text) -> void;
+    auto _update_threshold() -> void;
+    static auto _drain(void* self) -> void;
+
+    ILIAS_NAMESPACE::IoContext& mContext;
+    detail::LogRing mRing;
+    std::atomic<LogLevel> mThreshold{LogLevel::Off};
+    std::atomic<uint32_t> mMaxPerSecond;
+    std::atomic<uint32_t> mSampleEvery;
+    std::atomic<uint64_t> mSampleCounter{0};
+    std::atomic<int64_t> mWindow{0};
+    std::atomic<uint32_t> mWindowCount{0};
+    std::atomic<uint64_t> mDropped{0};
+    std::atomic<bool> mDrainPosted{false};
+    detail::PostGuard<LogPipeline> mPosts{this};
+    /// IoContext thread only
+    std::vector<Subscriber> mSubscribers;
+};
+CCMCP_EN
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+CCMCP_BN
+/**
+ * @brief Lock free latency histogram with HDR style log-linear buckets.
+ *
+ * The relative error of a bucket is bounded by 1/kSubBuckets, recording never allocates.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 3;
+    static constexpr uint64_t kSubBuckets    = 1U << kSubBucketBits;
+    /// Values are clamped to 2^kMaxBits - 1 (about 12 days in microseconds).
+    static constexpr unsigned kMaxBits       = 40;
+    static constexpr std::size_t kBucketCount = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    static constexpr auto bucketIndex(uint64_t value) noexcept -> std::size_t {
+        if (value >= (uint64_t(1) << kMaxBits)) {
+            value = (uint64_t(1) << kMaxBits) - 1;
+        }
+        if (value < kSubBuckets) {
+            return static_cast<std::size_t>(value);
+        }
+        const unsigned exponent = std::bit_width(value) - 1;
+        const auto sub          = (value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+        return static_cast<std::size_t>((exponent - kSubBucketBits + 1) * kSubBuckets + sub);
+    }
+    /// Largest value that falls into bucket `index`.
+    static constexpr auto bucketUpperBound(std::size_t index) noexcept -> uint64_t {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        const unsigned exponent = static_cast<unsigned>(index / kSubBuckets) + kSubBucketBits - 1;
+        const uint64_t lower    = (kSubBuckets + index % kSubBuckets) << (exponent - kSubBucketBits);
+        return lower + (uint64_t(1) << (exponent - kSubBucketBits)) - 1;
+    }
+
+    auto record(uint64_t value) noexcept -> void {
+        mBuckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        mCount.fetch_add(1, std::memory_order_relaxed);
+        mSum.fetch_add(value, std::memory_order_relaxed);
+        auto max = mMax.load(std::memory_order_relaxed);
+        while (value > max && !mMax.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    auto count() const noexcept -> uint64_t { return mCount.load(std::memory_order_relaxed); }
+    auto sum() const noexcept -> uint64_t { return mSum.load(std::memory_order_relaxed); }
+    auto max() const noexcept -> uint64_t { return mMax.load(std::memory_order_relaxed); }
+    auto bucket(std::size_t index) const noexcept -> uint64_t {
+        return mBuckets[index].load(std::memory_order_relaxed);
+    }
+    /// Upper bound of the bucket holding the `quantile` (0..1) value, 0 if nothing was recorded.
+    auto percentile(double quantile) const noexcept -> uint64_t;
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> mBuckets{};
+    std::atomic<uint64_t> mCount = 0;
+    std::atomic<uint64_t> mSum   = 0;
+    std::atomic<uint64_t> mMax   = 0;
+};
+
+struct ToolMetrics {
+    std::atomic<uint64_t> calls  = 0;
+    std::atomic<uint64_t> errors = 0;
+    /// tools/call latency in microseconds
+    LatencyHistogram latency;
+
+    auto record(uint64_t micros, bool isError) noexcept -> void {
+        calls.fetch_add(1, std::memory_order_relaxed);
+        if (isError) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        latency.record(micros);
+    }
+};
+
+/**
+ * @brief Server metrics, per tool counters and the process RSS.
+ *
+ * ToolMetrics are never removed, callers may keep the returned reference.
+ */
+class MetricsRegistry {
+public:
+    auto tool(std::string_view name) -> ToolMetrics&;
+    auto sampleRss() -> void;
+    /// Last sampled resident set size in bytes.
+    auto rss() const noexcept -> std::size_t { return mRss.load(std::memory_order_relaxed); }
+    /// Prometheus text exposition format.
+    auto exposition() const -> std::string;
+
+private:
+    mutable std::mutex mMutex;
+    std::map<std::string, std::unique_ptr<ToolMetrics>, std::less<>> mTools;
+    std::atomic<std::size_t> mRss = 0;
+};
+CCMCP_EN
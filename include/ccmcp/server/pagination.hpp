@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief Opaque list cursors, a page starts after the key of the last entry of the previous one.
+ */
+auto encode_cursor(std::string_view scope, std::string_view lastKey) -> std::string;
+/// The last key stored in `cursor`, nullopt if the cursor is malformed or was issued for another list.
+auto decode_cursor(std::string_view scope, std::string_view cursor) -> std::optional<std::string>;
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <ilias/io/context.hpp>
+
+#include <memory>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief Posts callbacks to an IoContext, a callback is skipped once its owner is destroyed.
+ *
+ * The owner must be destroyed on the IoContext thread.
+ */
+template <typename T>
+class PostGuard {
+public:
+    explicit PostGuard(T* owner) : mAlive(std::make_shared<T*>(owner)) {}
+    PostGuard(const PostGuard&)            = delete;
+    PostGuard& operator=(const PostGuard&) = delete;
+
+    /// Call `Func(owner)` on the thread of `context`, unless the owner is gone by then.
+    template <auto Func>
+    auto post(ILIAS_NAMESPACE::IoContext& context) const -> void {
+        context.post(&PostGuard::_run<Func>, new std::weak_ptr<T*>(mAlive));
+    }
+
+private:
+    template <auto Func>
+    static auto _run(void* data) -> void {
+        std::unique_ptr<std::weak_ptr<T*>> owner(static_cast<std::weak_ptr<T*>*>(data));
+        if (auto alive = owner->lock(); alive) {
+            Func(*alive);
+        }
+    }
+
+    std::shared_ptr<T*> mAlive;
+};
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/server/session.hpp"
+
+#include <ilias/task/spawn.hpp>
+#include <ilias/task/task.hpp>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief notifications/progress sender for one request, throttled per progress token.
+ *
+ * The last report of a burst is sent once the interval is over, flush() sends whatever is still pending.
+ */
+class ProgressReporter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// `token` is the raw JSON token taken from the request `_meta.progressToken`.
+    ProgressReporter(std::weak_ptr<McpSession> session, std::string token, std::chrono::milliseconds interval)
+        : mSession(std::move(session)), mToken(std::move(token)), mInterval(interval) {}
+    // The timer refers to the reporter.
+    ProgressReporter(const ProgressReporter&)            = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+    ~ProgressReporter() { _disarm(); }
+
+    auto report(float progress, std::optional<float> total) -> void;
+    auto flush() -> void;
+
+    auto sent() const noexcept -> std::size_t { return mSent; }
+
+private:
+    struct Progress {
+        float progress;
+        std::optional<float> total;
+    };
+
+    auto _send(const Progress& progress) -> void;
+    auto _trailing(Clock::duration delay) -> ILIAS_NAMESPACE::Task<void>;
+    auto _disarm() -> void;
+
+    std::weak_ptr<McpSession> mSession;
+    std::string mToken;
+    std::chrono::milliseconds mInterval;
+    std::optional<Clock::time_point> mLast;
+    std::optional<Progress> mPending;
+    ILIAS_NAMESPACE::StopHandle mTimer;
+    bool mArmed       = false;
+    std::size_t mSent = 0;
+};
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief LRU cache of serialized tools/call results, keyed by tool name and canonical arguments.
+ */
+class ToolResultCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Key of a call, empty if `arguments` is not valid JSON.
+    static auto makeKey(std::string_view tool, std::string_view arguments) -> std::string;
+
+    /// Bytes the cache may hold, 0 disables it and drops every entry.
+    auto setCapacity(std::size_t bytes) -> void;
+    auto capacity() const noexcept -> std::size_t { return mCapacity; }
+    auto enabled() const noexcept -> bool { return mCapacity != 0; }
+
+    /// Serialized CallToolResult stored for `key`, null on a miss or if it expired.
+    auto find(const std::string& key) -> std::shared_ptr<const std::string>;
+    /// Store `result` for a key made by makeKey().
+    auto insert(std::string key, std::shared_ptr<const std::string> result, std::chrono::milliseconds ttl) -> void;
+    /// Drop every result of `tool`.
+    auto invalidate(std::string_view tool) -> std::size_t;
+    auto clear() -> void;
+
+    auto size() const noexcept -> std::size_t { return mEntries.size(); }
+    auto bytes() const noexcept -> std::size_t { return mBytes; }
+    auto hits() const noexcept -> uint64_t { return mHits; }
+    auto misses() const noexcept -> uint64_t { return mMisses; }
+
+private:
+    struct Entry {
+        std::string key;
+        std::string tool;
+        std::shared_ptr<const std::string> result;
+        Clock::time_point expiry;
+
+        auto cost() const noexcept -> std::size_t { return key.size() + tool.size() + result->size() + sizeof(Entry); }
+    };
+    using List = std::list<Entry>;
+
+    auto _erase(List::iterator it) -> void;
+    auto _evict() -> void;
+
+    List mEntries; // most recently used first
+    std::unordered_map<std::string_view, List::iterator> mIndex;
+    std::size_t mCapacity = 0;
+    std::size_t mBytes    = 0;
+    uint64_t mHits        = 0;
+    uint64_t mMisses      = 0;
+};
+} // namespace detail
+CCMCP_EN
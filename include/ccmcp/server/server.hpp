@@ -4,6 +4,26 @@
 
 #include "ccmcp/model/jsonrpc_protocol.hpp"
 #include "ccmcp/model/model.hpp"
+#include "ccmcp/model/raw_message.hpp"
+#include "ccmcp/server/batch.hpp"
+#include "ccmcp/server/content_writer.hpp"
+#include "ccmcp/server/directory_index.hpp"
+#include "ccmcp/server/file_resource.hpp"
+#include "ccmcp/server/logging.hpp"
+#include "ccmcp/server/metrics.hpp"
+#include "ccmcp/server/post_guard.hpp"
+#include "ccmcp/server/progress.hpp"
+#include "ccmcp/server/result_cache.hpp"
+#include "ccmcp/server/session.hpp"
+#include "ccmcp/server/single_flight.hpp"
+#include "ccmcp/server/snapshot.hpp"
+#include "ccmcp/server/subscriptions.hpp"
+#include "ccmcp/server/tool_catalog.hpp"
+#include "ccmcp/server/tool_context.hpp"
+#include "ccmcp/server/tool_dispatch.hpp"
+#include "ccmcp/server/tool_executor.hpp"
+#include "ccmcp/server/tool_limiter.hpp"
+#include "ccmcp/server/uri_template.hpp"
 
 #include <ilias/io/context.hpp>
 #include <ilias/io/error.hpp>
@@ -11,12 +31,17 @@
 #include <ilias/task/spawn.hpp>
 #include <ilias/task/task.hpp>
 
+#include <chrono>
 #include <filesystem>
 #include <functional>
 #include <iterator>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
+#include <stop_token>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -28,7 +53,6 @@ CCMCP_BN
 template <typename ToolFunctions>
 class McpServer;
 
-using ResourceContents = std::variant<TextResourceContents, BlobResourceContents>;
 namespace detail {
 struct RpcMethodWrapper {
     template <typename U>
@@ -36,8 +60,30 @@ struct RpcMethodWrapper {
 
     virtual ~RpcMethodWrapper() = default;
 
-    virtual auto call(JsonSerializer::InputSerializer& in) -> IoTask<CallToolResult> = 0;
-    auto operator()(JsonSerializer::InputSerializer& in) -> IoTask<CallToolResult> { return call(in); }
+    virtual auto call(JsonSerializer::InputSerializer& in, ToolCallContext context) -> IoTask<CallToolResult> = 0;
+    /// Call with the raw `arguments` JSON taken from the request buffer, skipping the JsonValue DOM.
+    virtual auto callRaw(std::string_view arguments, ToolCallContext context) -> IoTask<CallToolResult> = 0;
+    /// Like callRaw(), but the content array is serialized onto the end of `out`. Returns isError.
+    virtual auto callJson(std::string_view arguments, ToolCallContext context, std::string& out) -> IoTask<bool> = 0;
+    /// False for handlers that need the JsonValue DOM, tools/call for them goes through JsonRpcServer.
+    virtual auto acceptsRawArguments() const noexcept -> bool { return false; }
+    virtual auto options() const noexcept -> const ToolOptions& = 0;
+    virtual auto annotations() const noexcept -> const std::optional<ToolAnnotations>& = 0;
+    /// tools/list entry of this version of the tool.
+    virtual auto tool() const -> Tool = 0;
+    /// A new version of the handler with `options` and `annotations`, serving the same tool function.
+    virtual auto withSettings(ToolOptions options, std::optional<ToolAnnotations> annotations) const
+        -> std::shared_ptr<RpcMethodWrapper> = 0;
+    auto operator()(JsonSerializer::InputSerializer& in) -> IoTask<CallToolResult> { return call(in, {}); }
+
+    /// Resolved from the server MetricsRegistry when the tool is published.
+    ToolMetrics* metrics = nullptr;
+};
+
+/// Settings published by setToolLimits() and setToolAnnotations(), in place of the ones of the tool function.
+struct ToolSettings {
+    ToolOptions options;
+    std::optional<ToolAnnotations> annotations;
 };
 
 template <typename McpServerT>
@@ -57,17 +103,29 @@ public:
         mDescription = description;
         return *this;
     }
+    RegisterFunctionHelper& setOptions(const ToolOptions& options) {
+        mOptions = options;
+        return *this;
+    }
+    RegisterFunctionHelper& setAnnotations(const ToolAnnotations& annotations) {
+        mAnnotations = annotations;
+        return *this;
+    }
     template <typename FunctionT>
 
     void operator=(FunctionT&& func) {
         if constexpr (requires(FunctionT&& func) {
                           mServer.registerToolFunction(mMethodName, std::function(std::forward<FunctionT>(func)),
-                                                       mDescription, mParameters);
+                                                       mDescription, mParameters, mOptions);
                       }) {
             mServer.registerToolFunction(mMethodName, std::function(std::forward<FunctionT>(func)), mDescription,
-                                         mParameters);
+                                         mParameters, mOptions);
         } else {
-            mServer.registerToolFunction(mMethodName, std::forward<FunctionT>(func), mDescription, mParameters);
+            mServer.registerToolFunction(mMethodName, std::forward<FunctionT>(func), mDescription, mParameters,
+                                         mOptions);
+        }
+        if (mAnnotations) {
+            mServer.setToolAnnotations(mMethodName, *mAnnotations);
         }
     }
 
@@ -76,11 +134,61 @@ private:
     std::string_view mMethodName;
     std::string_view mDescription;
     std::map<std::string_view, std::string> mParameters;
+    ToolOptions mOptions;
+    std::optional<ToolAnnotations> mAnnotations;
 };
 
-auto createResourceContentsFromFile(const std::filesystem::path& path, const std::string& uri) -> ResourceContents;
+/// One published version of the registered tools, see SnapshotCell.
+struct ToolRegistry {
+    ToolDispatchTable<RpcMethodWrapper> handlers;
+};
 } // namespace detail
 
+/// Reads the resource `uri` matched by a resource template, `variables` are the values of its expressions.
+using ResourceTemplateHandler =
+    std::function<ILIAS_NAMESPACE::IoTask<ResourceContents>(std::string uri, UriVariables variables)>;
+
+namespace detail {
+struct TemplateResource {
+    ResourceTemplate resourceTemplate;
+    std::shared_ptr<const ResourceTemplateHandler> handler;
+};
+
+/// One published version of the registered resources, see SnapshotCell.
+struct ResourceRegistry {
+    std::map<std::string, std::function<ResourceContents(std::optional<Meta> meta)>, std::less<>> contents;
+    std::map<std::string, Resource, std::less<>> list;
+    /// resources answered from the session router, without going through ReadResourceResult
+    std::map<std::string, std::shared_ptr<const LocalFileResource>, std::less<>> files;
+    /// roots registered with registerDirectoryResource(), listed after `list` and read through file:///{path}
+    std::vector<std::shared_ptr<DirectoryIndex>> directories;
+    /// templates registered with registerResourceTemplate(), matched after every exact URI
+    UriTemplateMatcher templates;
+    std::vector<TemplateResource> templateResources; // indexed by the matcher values
+};
+
+/// The published tools and resources, shared by the servers of a McpServerGroup.
+struct Registries {
+    std::shared_ptr<SnapshotCell<ToolRegistry>> tools = std::make_shared<SnapshotCell<ToolRegistry>>();
+    std::shared_ptr<SnapshotCell<ResourceRegistry>> resources = std::make_shared<SnapshotCell<ResourceRegistry>>();
+};
+
+/// Handler of a tool registered with a function, named `name`.
+template <typename SignatureT, typename FuncT>
+auto make_tool_handler(std::string_view name, FuncT func, std::string_view description,
+                       const std::map<std::string_view, std::string>& paramsDescription, const ToolOptions& options)
+    -> std::shared_ptr<RpcMethodWrapper>;
+/// Publish `handler` under `name`, false if the name is taken.
+auto publish_tool(SnapshotCell<ToolRegistry>& tools, MetricsRegistry& metrics, std::string_view name,
+                  std::shared_ptr<RpcMethodWrapper> handler) -> bool;
+/// Publish `resource` read through `contents`, true if it replaced a resource with the same URI.
+auto publish_resource(SnapshotCell<ResourceRegistry>& resources, Resource resource,
+                      std::function<ResourceContents(std::optional<Meta> meta)> contents) -> bool;
+} // namespace detail
+
+template <typename ToolFunctions>
+class McpServerGroup;
+
 template <>
 class McpServer<void> {
 protected:
@@ -107,11 +215,75 @@ protected:
     auto _initialize(InitializeRequestParams) noexcept -> IoTask<InitializeResult>;
     auto _initialized(EmptyRequestParams) noexcept -> IoTask<void>;
     auto _tools_call(ToolCallRequestParams) noexcept -> IoTask<CallToolResult>;
+    auto _tools_call_raw(detail::Responder responder, std::shared_ptr<std::vector<std::byte>> buffer,
+                         RawMessage message, std::shared_ptr<detail::RpcMethodWrapper> handler, std::string_view name,
+                         detail::ToolLimiter::Admission admission, std::string cacheKey, uint64_t generation,
+                         std::shared_ptr<detail::SharedToolCall> shared, std::stop_source stop) -> Task<void>;
+    /// Await a tool call, its wait for a running slot included, it ends with IoError::TimedOut past `timeout`.
+    template <typename T>
+    auto _await_tool(IoTask<T> call, std::stop_source stop, std::optional<std::chrono::milliseconds> timeout)
+        -> IoTask<T>;
+    static auto _expire(std::stop_source stop, std::chrono::milliseconds timeout) -> IoTask<void>;
+    /// Wait for a running slot of `limiter`, then run `call` holding it.
+    template <typename T>
+    auto _admitted(detail::ToolLimiter& limiter, std::size_t maxConcurrency, detail::ToolLimiter::Admission admission,
+                   std::stop_token stop, IoTask<T> call) -> IoTask<T>;
+    auto _tool_timeout(const detail::RpcMethodWrapper& handler, std::optional<std::string_view> meta)
+        -> std::optional<std::chrono::milliseconds>;
+    auto _join_shared_call(const std::shared_ptr<detail::SharedToolCall>& shared,
+                           const std::shared_ptr<detail::McpSession>& session, detail::Responder responder,
+                           std::string_view id) -> void;
     auto _tools_list(PaginatedRequest) noexcept -> IoTask<ToolsListResult>;
+    auto _resources_list(PaginatedRequest) noexcept -> IoTask<ListResourcesResult>;
+    auto _resources_read(ReadResourceRequestParams) noexcept -> IoTask<ReadResourceResult>;
+    auto _resource_templates_list(PaginatedRequest) noexcept -> IoTask<ListResourceTemplatesResult>;
     auto _cancelled(CancelledNotificationParams) noexcept -> IoTask<void>;
+    auto _cache_ttl(const detail::RpcMethodWrapper& handler) -> std::chrono::milliseconds;
+    /// Changes whenever the cached results of `name` are dropped, a result computed across a change is not cached.
+    auto _results_generation(std::string_view name) const -> uint64_t;
+    auto _sample_rss() -> Task<void>;
+    auto _tools_snapshot() -> std::shared_ptr<const detail::ToolCatalog::Snapshot>;
+    auto _invalidate_tools() -> void;
+    auto _publish_tool(std::string_view name, std::shared_ptr<detail::RpcMethodWrapper> handler) -> bool;
+    /// Send the list_changed notifications for what was published since the last call, on the IoContext thread.
+    auto _schedule_list_changed() -> void;
+    static auto _on_list_changed(void* self) -> void;
+    /// Pick up what another server published to the shared registries, see McpServerGroup.
+    auto _registries_changed(bool tools, bool resources) -> void;
+    auto _limiter(std::string_view name) -> detail::ToolLimiter&;
+    auto _broadcast(std::shared_ptr<const std::string> message) -> void;
+    auto _route_message(const std::shared_ptr<detail::McpSession>& session, std::vector<std::byte>& buffer) -> bool;
+    auto _route_batch(const std::shared_ptr<detail::McpSession>& session, std::vector<std::byte>& buffer) -> bool;
+    auto _raw_tool(const RawMessage& message)
+        -> std::pair<std::shared_ptr<detail::RpcMethodWrapper>, std::string_view>;
+    auto _start_tools_call(const std::shared_ptr<detail::McpSession>& session, detail::Responder responder,
+                           std::shared_ptr<std::vector<std::byte>> buffer, const RawMessage& message,
+                           std::shared_ptr<detail::RpcMethodWrapper> handler, std::string_view name) -> void;
+    auto _reply_tools_list(const detail::Responder& responder, const RawMessage& message) -> void;
+    auto _resource_uri(const RawMessage& message) -> std::optional<std::string_view>;
+    auto _reply_file_resource(const detail::Responder& responder, const RawMessage& message) -> bool;
+    /// Byte range asked for through `"_meta":{"offset":N,"length":M}`, values that are not byte counts are ignored.
+    auto _meta_range(const RawMessage& message) -> std::optional<detail::ByteRange>;
+    auto _find_file_resource(const detail::ResourceRegistry& resources, std::string_view uri)
+        -> std::shared_ptr<const detail::LocalFileResource>;
+    auto _subscribe(const std::shared_ptr<detail::McpSession>& session, const detail::Responder& responder,
+                    const RawMessage& message) -> void;
+    auto _close_session(detail::McpSession& session) -> void;
+    static auto _on_resources_updated(void* self) -> void;
+    auto _set_log_level(const std::shared_ptr<detail::McpSession>& session, const detail::Responder& responder,
+                        const RawMessage& message) -> void;
+
+    template <typename, typename>
+    friend class detail::SessionStream;
+    template <typename>
+    friend class McpServerGroup;
 
 public:
     McpServer(IoContext& ctx);
+    /// Record the tool metrics into `metrics`, which may be shared with other servers.
+    McpServer(IoContext& ctx, std::shared_ptr<MetricsRegistry> metrics);
+    /// Serve the tools and resources published in `registries`, which may be shared with servers on other threads.
+    McpServer(IoContext& ctx, std::shared_ptr<MetricsRegistry> metrics, detail::Registries registries);
     auto setCapabilities(const ExperimentalCapabilities& capabilities) noexcept -> void;
     auto setCapabilities(const LoggingCapability& capabilities) noexcept -> void;
     auto setCapabilities(const CompletionsCapability& capabilities) noexcept -> void;
@@ -119,48 +291,142 @@ public:
     auto setCapabilities(const ResourcesCapability& capabilities) noexcept -> void;
     auto setCapabilities(const ToolsCapability& capabilities) noexcept -> void;
     void setInstructions(std::string_view instructions) noexcept;
+    /// Maximum number of entries per tools/list, resources/list and resources/templates/list page, 0 returns everything
+    /// in one page.
+    void setPageSize(std::size_t pageSize) noexcept;
     virtual auto toolsList(const PaginatedRequest&) -> ToolsListResult;
     template <typename StreamType>
     auto addTransport(StreamType&& stream) -> void;
     auto close() -> void;
     auto wait() -> Task<void>;
+    /// Send a notification to every connected session.
+    template <typename ParamsT>
+    auto notify(std::string_view method, const ParamsT& params) -> void;
+    /// Send notifications/resources/updated to the sessions subscribed to `uri`, callable from any thread. Also sent
+    /// when a registered resource is registered again.
+    auto notifyResourceUpdated(std::string_view uri) -> void;
+    auto subscriptions() const noexcept -> const detail::SubscriptionIndex& { return mSubscriptions; }
     template <typename Ret, typename... Args>
     auto registerToolFunction(std::string_view name, std::function<Ret(Args...)> func,
                               std::string_view description                                     = "",
-                              const std::map<std::string_view, std::string>& paramsDescription = {}) -> bool;
+                              const std::map<std::string_view, std::string>& paramsDescription = {},
+                              const ToolOptions& options                                       = {}) -> bool;
     template <typename Ret, typename... Args>
     auto registerToolFunction(std::string_view name, std::function<IoTask<Ret>(Args...)> func,
                               std::string_view description                                     = "",
-                              const std::map<std::string_view, std::string>& paramsDescription = {}) -> bool;
+                              const std::map<std::string_view, std::string>& paramsDescription = {},
+                              const ToolOptions& options                                       = {}) -> bool;
+    /// Thread pool for synchronous tools, `offloadByDefault` applies to tools whose ToolOptions::offload is unset.
+    auto setToolExecutor(std::shared_ptr<ToolExecutor> executor, bool offloadByDefault = true) -> void;
+    /// Run `func` on the tool executor and resume on the server IoContext, inline if there is no executor.
+    template <typename FuncT>
+    auto runBlocking(FuncT func, std::stop_token stop = {}) -> IoTask<std::invoke_result_t<FuncT&>>;
+    auto shouldOffload(const ToolOptions& options) const noexcept -> bool;
+    /// Change the concurrency limits of a registered tool, calls already admitted are not affected.
+    auto setToolLimits(std::string_view name, std::size_t maxConcurrency, std::size_t maxQueue = 0) -> bool;
+    /// Replace the annotations of a registered tool, its cached results are dropped. Callable from any thread.
+    auto setToolAnnotations(std::string_view name, const ToolAnnotations& annotations) -> bool;
+    /// Cache the results of read-only and idempotent tools (and of tools with ToolOptions::cacheTtl set), bounded to
+    /// `maxBytes`. 0 disables the cache.
+    auto setResultCache(std::size_t maxBytes, std::chrono::milliseconds defaultTtl = std::chrono::seconds(60)) -> void;
+    /// Drop the cached results of `name`, or of every tool if `name` is empty. Callable from any thread.
+    auto invalidateToolResults(std::string_view name = {}) -> void;
+    auto resultCache() const noexcept -> const detail::ToolResultCache& { return mResultCache; }
+    /// Keep the contents of local file resources in memory, bounded to `maxBytes`. 0 disables the cache.
+    auto setFileCache(std::size_t maxBytes) -> void { mFileCache.setCapacity(maxBytes); }
+    auto fileCache() const noexcept -> const detail::FileContentCache& { return mFileCache; }
+    auto metrics() noexcept -> MetricsRegistry& { return *mMetrics; }
+    /// Serve the metrics text exposition as a text/plain resource at `uri`.
+    auto registerMetricsResource(std::string_view uri = "metrics://server") -> void;
+    /// Period of the background RSS sampling, started with the first transport.
+    void setRssSampleInterval(std::chrono::milliseconds interval) noexcept;
+    /// Minimum time between two notifications/progress of the same request, later updates are coalesced.
+    void setProgressInterval(std::chrono::milliseconds interval) noexcept;
+    /// Forward a record to the sessions that asked for `level` with logging/setLevel, see LogPipeline::log().
+    template <typename... Args>
+    auto log(LogLevel level, std::string_view logger, fmt::format_string<Args...> format, Args&&... args) -> void {
+        mLog.log(level, logger, format, std::forward<Args>(args)...);
+    }
+    auto logPipeline() noexcept -> LogPipeline& { return mLog; }
     auto jsonRpcServer() -> JsonRpcServer<detail::McpJsonRpcMethods>&;
+    /// Serve the file at `path`, read on every resources/read. A read may ask for a part of it, see ByteRange.
     auto registerLocalFileResource(std::string_view name, std::filesystem::path path, std::string_view uri = "",
-                                   std::string_view description = "") -> bool;
+                                   std::string_view description = "", const FileResourceOptions& options = {}) -> bool;
+    /// Serve the URIs matching `resourceTemplate.uriTemplate` through `handler`, see UriTemplateMatcher for the
+    /// supported templates. False if the template is malformed or already registered.
+    auto registerResourceTemplate(ResourceTemplate resourceTemplate, ResourceTemplateHandler handler) -> bool;
+    /// Serve every file below `root` as a resource, listed lazily and read through the file:///{path} template.
+    auto registerDirectoryResource(std::filesystem::path root, const FileResourceOptions& options = {}) -> bool;
     auto registerResource(Resource resource, ResourceContents) -> void;
     auto registerResource(Resource resource, std::function<ResourceContents(std::optional<Meta> meta)>) -> void;
     auto server() -> JsonRpcServer<detail::McpJsonRpcMethods>& { return mServer; }
 
 protected:
+    IoContext* mContext;
     JsonRpcServer<detail::McpJsonRpcMethods> mServer;
     std::string mInstructions;
-    std::map<std::string_view, std::unique_ptr<detail::RpcMethodWrapper>> mHandlers;
-
-    // for tools
-    std::vector<std::function<Tool()>> mTools;
-
-    // for resources
-    std::map<std::string, std::function<ResourceContents(std::optional<Meta> meta)>> mResources;
-    std::vector<Resource> mResourceList;
+    std::vector<std::weak_ptr<detail::McpSession>> mSessions;
+    uint64_t mSessionId = 0;
+
+    // for tools and resources, registration may happen on any thread while requests are served
+    std::shared_ptr<detail::SnapshotCell<detail::ToolRegistry>> mToolRegistry;
+    detail::ToolCatalog mToolCatalog;
+    std::shared_ptr<detail::SnapshotCell<detail::ResourceRegistry>> mResourceRegistry;
+    std::map<std::string, detail::ToolLimiter, std::less<>> mLimiters;
+    detail::PostGuard<McpServer> mPosts{this};
+    std::atomic<bool> mListChangedPosted{false};
+    std::atomic<bool> mToolsChanged{false};
+    std::atomic<bool> mLimitsChanged{false};
+    std::atomic<bool> mResourcesChanged{false};
     ServerCapabilities mCapabilities;
+    std::size_t mPageSize = 0;
+    std::shared_ptr<ToolExecutor> mToolExecutor;
+    bool mOffloadByDefault = false;
+
+    // for tools/call results
+    detail::ToolResultCache mResultCache;
+    std::chrono::milliseconds mCacheTtl{std::chrono::seconds(60)};
+    std::map<std::string, std::shared_ptr<detail::SharedToolCall>, std::less<>> mSharedCalls;
+    std::mutex mInvalidatedMutex;
+    std::vector<std::string> mInvalidatedTools;
+    std::map<std::string, uint64_t, std::less<>> mToolResultsGenerations;
+    uint64_t mResultsGeneration = 0;
+
+    // for resources/read of local files
+    detail::FileContentCache mFileCache;
+
+    // for resources/subscribe
+    detail::SubscriptionIndex mSubscriptions;
+    std::mutex mUpdatedMutex;
+    std::vector<std::string> mUpdatedResources;
+    std::atomic<bool> mUpdatedPosted{false};
+
+    // for metrics
+    std::shared_ptr<MetricsRegistry> mMetrics;
+    ScopedCancelHandle mRssSampler;
+    std::chrono::milliseconds mRssInterval{1000};
+
+    // for streaming tools
+    std::chrono::milliseconds mProgressInterval{100};
+
+    // for notifications/message
+    LogPipeline mLog;
 };
 
 template <typename ToolFunctions>
 class McpServer final : public McpServer<void> {
 public:
     McpServer(IoContext& ctx) : McpServer<void>(ctx) { _register_tool_functions(); }
+    McpServer(IoContext& ctx, std::shared_ptr<MetricsRegistry> metrics) : McpServer<void>(ctx, std::move(metrics)) {
+        _register_tool_functions();
+    }
+    /// Serve the tool functions of `functions`, already published in `registries`.
+    McpServer(IoContext& ctx, std::shared_ptr<MetricsRegistry> metrics, detail::Registries registries,
+              std::shared_ptr<ToolFunctions> functions)
+        : McpServer<void>(ctx, std::move(metrics), std::move(registries)), mToolFunctions(std::move(functions)) {}
 
-    auto* operator->() { return &mToolFunctions; }
-    const auto* operator->() const { return &mToolFunctions; }
-    auto toolsList(const PaginatedRequest&) -> ToolsListResult override;
+    auto* operator->() { return mToolFunctions.get(); }
+    const auto* operator->() const { return mToolFunctions.get(); }
     auto registerToolFunction(std::string_view name) -> detail::RegisterFunctionHelper<McpServer>;
     using McpServer<void>::registerToolFunction;
 
@@ -168,7 +434,8 @@ private:
     void _register_tool_functions();
 
 private:
-    ToolFunctions mToolFunctions;
+    /// Shared with the published handlers, which may outlive this server when the registry is shared.
+    std::shared_ptr<ToolFunctions> mToolFunctions = std::make_shared<ToolFunctions>();
 };
 
 namespace detail {
@@ -191,81 +458,228 @@ struct RpcMethodType<T*> {
     using MethodT = T;
 };
 
-template <typename T, typename ToolFunctions>
+template <typename T>
 struct RpcMethodWrapperImpl : public RpcMethodWrapper {
     template <typename U>
     using IoTask = ILIAS_NAMESPACE::IoTask<U>;
     template <typename U>
     using Result  = ILIAS_NAMESPACE::IoResult<U>;
     using MethodT = std::decay_t<typename RpcMethodType<T>::MethodT>;
-    RpcMethodWrapperImpl(T method, McpServer<ToolFunctions>* self) : method(std::move(method)), self(self) {}
+    explicit RpcMethodWrapperImpl(T method) : method(std::move(method)) {}
 
     T method;
-    McpServer<ToolFunctions>* self;
-    auto call(JsonSerializer::InputSerializer& in) -> IoTask<CallToolResult> override {
+    using RetT = typename MethodT::ReturnT;
+
+    auto call(JsonSerializer::InputSerializer& in, ToolCallContext context) -> IoTask<CallToolResult> override {
+        CallToolResult result{.content = {}, .isError = true, .metadata = {}};
+        auto respon = co_await _invoke(in, context);
+        if (respon) {
+            if constexpr (traits::is_tool_stream<RetT>) {
+                ilias_for_await(auto& update, respon.value()) {
+                    if (update.content) {
+                        _append_content(result, *update.content);
+                    }
+                    if (update.progress && context.progress != nullptr) {
+                        context.progress->report(*update.progress, update.total);
+                    }
+                }
+                if (context.progress != nullptr) {
+                    context.progress->flush();
+                }
+            } else {
+                _append_content(result, respon.value());
+            }
+            result.isError = false;
+        }
+        co_return result;
+    }
+    auto callRaw(std::string_view arguments, ToolCallContext context) -> IoTask<CallToolResult> override {
+        auto in = _arguments(arguments);
+        co_return co_await call(in, std::move(context));
+    }
+    auto callJson(std::string_view arguments, ToolCallContext context, std::string& out) -> IoTask<bool> override {
+        if constexpr (traits::is_tool_stream<RetT>) {
+            auto ret = co_await callRaw(arguments, std::move(context));
+            if (!ret) {
+                co_return ILIAS_NAMESPACE::Err(ret.error());
+            }
+            out.append(serialize_json(ret.value().content));
+            co_return ret.value().isError;
+        } else {
+            auto in     = _arguments(arguments);
+            auto respon = co_await _invoke(in, context);
+            if (!respon) {
+                co_return true;
+            }
+            append_content_json(out, respon.value());
+            co_return false;
+        }
+    }
+    auto acceptsRawArguments() const noexcept -> bool override { return true; }
+    auto options() const noexcept -> const ToolOptions& override {
+        return settings ? settings->options : method->options;
+    }
+    auto annotations() const noexcept -> const std::optional<ToolAnnotations>& override {
+        return settings ? settings->annotations : method->annotations;
+    }
+    auto tool() const -> Tool override {
+        auto entry = method->tool();
+        if (settings) {
+            entry.annotations = settings->annotations;
+        }
+        return entry;
+    }
+    auto withSettings(ToolOptions options, std::optional<ToolAnnotations> annotations) const
+        -> std::shared_ptr<RpcMethodWrapper> override {
+        auto copy      = std::make_shared<RpcMethodWrapperImpl>(*this);
+        copy->settings = ToolSettings{.options = std::move(options), .annotations = std::move(annotations)};
+        return copy;
+    }
+
+    /// Unset until the settings are changed through the server, the ones of the tool function apply.
+    std::optional<ToolSettings> settings;
+
+private:
+    static auto _arguments(std::string_view arguments) -> JsonSerializer::InputSerializer {
+        if (arguments.empty() || arguments == "null") {
+            arguments = "{}";
+        }
+        return JsonSerializer::InputSerializer(arguments.data(), arguments.size());
+    }
+    auto _invoke(JsonSerializer::InputSerializer& in, const ToolCallContext& context) -> IoTask<RetT> {
         if (!(*method)) {
-            co_return CallToolResult{.content = {}, .isError = true, .metadata = {}};
+            co_return ILIAS_NAMESPACE::Err(ILIAS_NAMESPACE::IoError::Unknown);
         }
-        using RetT = typename MethodT::ReturnT;
-        CallToolResult result{.content = {}, .isError = true, .metadata = {}};
         Result<RetT> respon = ILIAS_NAMESPACE::Err(ILIAS_NAMESPACE::IoError::Unknown);
+        // Creating a generator does not run it, streaming tools always stay on the IoContext thread.
+        const bool offload = !traits::is_tool_stream<RetT> && method->isBlocking() && context.server != nullptr &&
+                             context.server->shouldOffload(options());
         if constexpr (std::is_void_v<typename MethodT::ParamsT>) {
-            respon = co_await (*method)();
+            if (offload) {
+                // The deadline and cancellation end the call right away, the tool then finishes in the background
+                // and may outlive the server, so the job holds the function itself.
+                respon = co_await context.server->runBlocking(
+                    [func = method->blockingFunction(), stop = context.stop]() {
+                        StopTokenScope scope(stop);
+                        return (*func)();
+                    },
+                    context.stop);
+            } else {
+                // A synchronous tool run inline does not suspend, the scope cannot leak into other coroutines.
+                std::optional<StopTokenScope> scope;
+                if (method->isBlocking()) {
+                    scope.emplace(context.stop);
+                }
+                respon = co_await (*method)();
+            }
         } else {
             typename MethodT::ParamsT params;
             if (in(params)) {
-                respon = co_await (*method)(std::move(params));
-            }
-        }
-        if (respon) {
-            if constexpr (NEKO_NAMESPACE::detail::has_values_meta<RetT>) {
-                Reflect<RetT>::forEach(respon.value(),
-                                       [&result](auto& field) { result.content.push_back(make_content(field)); });
-            }
-            if constexpr (requires { std::begin(respon.value()); } && !(std::is_same_v<RetT, std::string>) &&
-                          !(std::is_same_v<RetT, std::u8string>) && !(std::is_same_v<RetT, std::string_view>) &&
-                          !(std::is_same_v<RetT, std::u8string_view>)) {
-                for (auto& item : respon.value()) {
-                    result.content.push_back(make_content(item));
+                if (offload) {
+                    respon = co_await context.server->runBlocking(
+                        [func = method->blockingFunction(), params = std::move(params), stop = context.stop]() mutable {
+                            StopTokenScope scope(stop);
+                            return (*func)(std::move(params));
+                        },
+                        context.stop);
+                } else {
+                    std::optional<StopTokenScope> scope;
+                    if (method->isBlocking()) {
+                        scope.emplace(context.stop);
+                    }
+                    respon = co_await (*method)(std::move(params));
                 }
-            } else {
-                result.content.push_back(make_content(respon.value()));
             }
-            result.isError = false;
         }
-        co_return result;
+        co_return std::move(respon);
+    }
+    template <typename U>
+    static auto _append_content(CallToolResult& result, U& value) -> void {
+        for_each_content_item(value, [&result](const auto& item) { result.content.push_back(make_content(item)); });
     }
 };
+
+/// Publish the tool functions of `functions` into `tools`, `onChange` runs when a description is reassigned.
+template <typename ToolFunctions>
+auto publish_static_tools(const std::shared_ptr<ToolFunctions>& functions, SnapshotCell<ToolRegistry>& tools,
+                          MetricsRegistry& metrics, std::function<void()> onChange) -> void {
+    static_assert(!std::is_empty_v<ToolFunctions>, "ToolFunctions must be a non-empty class or struct");
+    std::vector<std::string_view> names;
+    std::vector<std::shared_ptr<RpcMethodWrapper>> handlers;
+    Reflect<ToolFunctions>::forEach(*functions, [&](auto& rpcMethodMetadata) {
+        using MethodT = std::decay_t<decltype(rpcMethodMetadata)>;
+        names.push_back(rpcMethodMetadata.name);
+        // The descriptions of a static tool can be reassigned through operator->, tools/list is rebuilt then.
+        rpcMethodMetadata.paramsDescription.setOnChange(onChange);
+        handlers.push_back(std::make_shared<RpcMethodWrapperImpl<std::shared_ptr<MethodT>>>(
+            std::shared_ptr<MethodT>(functions, &rpcMethodMetadata)));
+    });
+    for (std::size_t idx = 0; idx < names.size(); ++idx) {
+        handlers[idx]->metrics = &metrics.tool(names[idx]);
+    }
+    bool perfect = true;
+    tools.update([&](ToolRegistry& registry) {
+        perfect = registry.handlers.setStatic(std::move(names), std::move(handlers));
+        return true;
+    });
+    if (!perfect) {
+        NEKO_LOG_WARN("mcp server", "failed to build perfect hash for tool functions, fallback to hash map");
+    }
+}
 } // namespace detail
 template <typename ToolFunctions>
 void McpServer<ToolFunctions>::_register_tool_functions() {
-    if constexpr (std::is_empty_v<ToolFunctions> || std::is_void_v<ToolFunctions>) {
-        static_assert(!std::is_empty_v<ToolFunctions>, "ToolFunctions must be a non-empty class or struct");
-    } else {
-        Reflect<ToolFunctions>::forEach(mToolFunctions, [this](auto& rpcMethodMetadata) {
-            using MethodT = std::decay_t<decltype(rpcMethodMetadata)>;
-            mHandlers[rpcMethodMetadata.name] =
-                std::make_unique<detail::RpcMethodWrapperImpl<MethodT*, ToolFunctions>>(&rpcMethodMetadata, this);
-        });
-    }
+    detail::publish_static_tools(mToolFunctions, *mToolRegistry, *mMetrics, [this]() {
+        mToolsChanged.store(true, std::memory_order_release);
+        _schedule_list_changed();
+    });
 }
 
 template <typename StreamType>
 inline auto McpServer<void>::addTransport(StreamType&& stream) -> void {
-    mServer.addEndpoint(std::forward<StreamType>(stream));
+    using StreamT = std::decay_t<StreamType>;
+    auto session  = std::make_shared<detail::SessionState<StreamT>>(++mSessionId, std::forward<StreamType>(stream));
+    mSessions.push_back(session);
+    if (!mRssSampler) {
+        mRssSampler = ILIAS_NAMESPACE::spawn(_sample_rss());
+    }
+    mServer.addEndpoint(detail::SessionStream<StreamT, McpServer<void>>(std::move(session), this));
 }
 
-template <typename ToolFunctions>
-auto McpServer<ToolFunctions>::toolsList(const PaginatedRequest& params) -> ToolsListResult {
-    ToolsListResult result = McpServer<void>::toolsList(params);
-    if constexpr (std::is_empty_v<ToolFunctions> || std::is_void_v<ToolFunctions>) {
-        return result;
-    } else {
-        Reflect<ToolFunctions>::forEach(mToolFunctions, [&](auto& tool) { result.tools.push_back(tool.tool()); });
-        return result;
+template <typename FuncT>
+inline auto McpServer<void>::runBlocking(FuncT func, std::stop_token stop) -> IoTask<std::invoke_result_t<FuncT&>> {
+    if (!mToolExecutor) {
+        if constexpr (std::is_void_v<std::invoke_result_t<FuncT&>>) {
+            func();
+            co_return {};
+        } else {
+            co_return func();
+        }
     }
+    co_return co_await offload(*mToolExecutor, *mContext, std::move(func), std::move(stop));
+}
+
+template <typename ParamsT>
+inline auto McpServer<void>::notify(std::string_view method, const ParamsT& params) -> void {
+    _broadcast(std::make_shared<const std::string>(
+        detail::serialize_json(JsonRpcNotification<ParamsT>{.method = std::string(method), .params = params})));
 }
 
+namespace detail {
+template <typename SignatureT, typename FuncT>
+auto make_tool_handler(std::string_view name, FuncT func, std::string_view description,
+                       const std::map<std::string_view, std::string>& paramsDescription, const ToolOptions& options)
+    -> std::shared_ptr<RpcMethodWrapper> {
+    using MethodT = DynamicToolFunction<std::function<SignatureT>>;
+    MethodT rpcMethodMetadata(name, description);
+    rpcMethodMetadata                   = std::move(func);
+    rpcMethodMetadata.paramsDescription = paramsDescription;
+    rpcMethodMetadata.options           = options;
+    return std::make_shared<RpcMethodWrapperImpl<std::shared_ptr<MethodT>>>(
+        std::make_shared<MethodT>(std::move(rpcMethodMetadata)));
+}
+} // namespace detail
+
 template <typename ToolFunctions>
 auto McpServer<ToolFunctions>::registerToolFunction(std::string_view name)
     -> detail::RegisterFunctionHelper<McpServer> {
@@ -275,37 +689,25 @@ auto McpServer<ToolFunctions>::registerToolFunction(std::string_view name)
 template <typename Ret, typename... Args>
 auto McpServer<void>::registerToolFunction(std::string_view name, std::function<Ret(Args...)> func,
                                            std::string_view description,
-                                           const std::map<std::string_view, std::string>& paramsDescription) -> bool {
-    if (mHandlers.find(name) != mHandlers.end()) {
+                                           const std::map<std::string_view, std::string>& paramsDescription,
+                                           const ToolOptions& options) -> bool {
+    if (mToolRegistry->load()->handlers.contains(name)) {
         return false;
     }
-    using MethodT = DynamicToolFunction<std::function<Ret(Args...)>>;
-    MethodT rpcMethodMetadata(name, description);
-    rpcMethodMetadata                   = func;
-    rpcMethodMetadata.paramsDescription = paramsDescription;
-    auto wrapper = std::make_unique<detail::RpcMethodWrapperImpl<std::unique_ptr<MethodT>, void>>(
-        std::make_unique<MethodT>(std::move(rpcMethodMetadata)), this);
-    mTools.push_back(std::function([method = wrapper->method.get()]() { return method->tool(); }));
-    mHandlers[name] = std::move(wrapper);
-    return true;
+    return _publish_tool(
+        name, detail::make_tool_handler<Ret(Args...)>(name, std::move(func), description, paramsDescription, options));
 }
 
 template <typename Ret, typename... Args>
 auto McpServer<void>::registerToolFunction(std::string_view name, std::function<IoTask<Ret>(Args...)> func,
                                            std::string_view description,
-                                           const std::map<std::string_view, std::string>& paramsDescription) -> bool {
-    if (mHandlers.find(name) != mHandlers.end()) {
+                                           const std::map<std::string_view, std::string>& paramsDescription,
+                                           const ToolOptions& options) -> bool {
+    if (mToolRegistry->load()->handlers.contains(name)) {
         return false;
     }
-    using MethodT = DynamicToolFunction<std::function<Ret(Args...)>>;
-    MethodT rpcMethodMetadata(name, description);
-    rpcMethodMetadata                   = func;
-    rpcMethodMetadata.paramsDescription = paramsDescription;
-    auto wrapper = std::make_unique<detail::RpcMethodWrapperImpl<std::unique_ptr<MethodT>, void>>(
-        std::make_unique<MethodT>(std::move(rpcMethodMetadata)), this);
-    mTools.push_back(std::function([method = wrapper->method.get()]() { return method->tool(); }));
-    mHandlers[name] = std::move(wrapper);
-    return true;
+    return _publish_tool(
+        name, detail::make_tool_handler<Ret(Args...)>(name, std::move(func), description, paramsDescription, options));
 }
 
 CCMCP_EN
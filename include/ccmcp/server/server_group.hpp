@@ -0,0 +1,234 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/io/sse_stream.hpp"
+#include "ccmcp/server/server.hpp"
+
+#include <ilias/net/tcp.hpp>
+#include <ilias/platform.hpp>
+#include <ilias/task/spawn.hpp>
+#include <nekoproto/global/log.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+CCMCP_BN
+/**
+ * @brief Multi threaded SSE server, one event loop thread (shard) per core.
+ *
+ * The shards share the tool and resource registries and the MetricsRegistry, tools are called from every shard
+ * thread. Result caches, limiters, file caches and subscriptions stay per shard. The listeners should be bound with
+ * SO_REUSEPORT.
+ */
+template <typename ToolFunctions = void>
+class McpServerGroup {
+public:
+    using ServerT = McpServer<ToolFunctions>;
+    /// Configure the server of one shard, called on that shard's thread.
+    using Setup = std::function<void(ServerT& server, std::size_t shard)>;
+    /// Create the listening socket of one shard, called on that shard's thread.
+    using Bind = std::function<ILIAS_NAMESPACE::IoTask<ILIAS_NAMESPACE::TcpListener>(std::size_t shard)>;
+
+    explicit McpServerGroup(std::size_t shards = std::thread::hardware_concurrency())
+        : mRouter(std::make_shared<NEKO_NAMESPACE::SseShardRouter>(shards == 0 ? 1 : shards)),
+          mShards(mRouter->shardCount()) {
+        if constexpr (!std::is_void_v<ToolFunctions>) {
+            mToolFunctions = std::make_shared<ToolFunctions>();
+            detail::publish_static_tools(mToolFunctions, *mRegistries.tools, *mMetrics,
+                                         [this]() { _registries_changed(true, false); });
+        }
+    }
+    McpServerGroup(const McpServerGroup&)            = delete;
+    McpServerGroup& operator=(const McpServerGroup&) = delete;
+    ~McpServerGroup() {
+        stop();
+        wait();
+    }
+
+    auto shardCount() const noexcept -> std::size_t { return mShards.size(); }
+
+    /// Start every shard thread.
+    auto start(Setup setup, Bind bind) -> void {
+        mSetup = std::move(setup);
+        mBind  = std::move(bind);
+        for (std::size_t shard = 0; shard < mShards.size(); ++shard) {
+            mThreads.emplace_back([this, shard]() { _run(shard); });
+        }
+    }
+    /// Ask every shard to close its listener and its server, callable from any thread. A shard still starting closes
+    /// as soon as it is listening.
+    auto stop() -> void {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+        for (auto& shard : mShards) {
+            if (shard.context != nullptr) {
+                shard.context->post(&McpServerGroup::_close, &shard);
+            }
+        }
+    }
+    /// Join the shard threads.
+    auto wait() -> void {
+        for (auto& thread : mThreads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        mThreads.clear();
+    }
+
+    /// Shared by the servers of every shard.
+    auto metrics() noexcept -> MetricsRegistry& { return *mMetrics; }
+    auto* operator->() { return mToolFunctions.get(); }
+    const auto* operator->() const { return mToolFunctions.get(); }
+    /// Publish a tool to every shard, see McpServer::registerToolFunction(). Callable from any thread.
+    template <typename Ret, typename... Args>
+    auto registerToolFunction(std::string_view name, std::function<Ret(Args...)> func,
+                              std::string_view description                                     = "",
+                              const std::map<std::string_view, std::string>& paramsDescription = {},
+                              const ToolOptions& options                                       = {}) -> bool {
+        return _publish_tool(name, detail::make_tool_handler<Ret(Args...)>(name, std::move(func), description,
+                                                                           paramsDescription, options));
+    }
+    template <typename Ret, typename... Args>
+    auto registerToolFunction(std::string_view name, std::function<IoTask<Ret>(Args...)> func,
+                              std::string_view description                                     = "",
+                              const std::map<std::string_view, std::string>& paramsDescription = {},
+                              const ToolOptions& options                                       = {}) -> bool {
+        return _publish_tool(name, detail::make_tool_handler<Ret(Args...)>(name, std::move(func), description,
+                                                                           paramsDescription, options));
+    }
+    /// Publish a resource to every shard, see McpServer::registerResource(). Callable from any thread.
+    auto registerResource(Resource resource, ResourceContents contents) -> void {
+        auto constant = [contents = std::move(contents)](std::optional<Meta>) -> ResourceContents { return contents; };
+        registerResource(std::move(resource), std::move(constant));
+    }
+    auto registerResource(Resource resource, std::function<ResourceContents(std::optional<Meta> meta)> contents)
+        -> void {
+        auto uri = resource.uri;
+        if (detail::publish_resource(*mRegistries.resources, std::move(resource), std::move(contents))) {
+            notifyResourceUpdated(uri);
+        }
+        _registries_changed(false, true);
+    }
+    /// Drop the cached results of `name` on every running shard, see McpServer::invalidateToolResults().
+    auto invalidateToolResults(std::string_view name = {}) -> void {
+        std::lock_guard lock(mMutex);
+        for (auto& shard : mShards) {
+            if (shard.server != nullptr) {
+                shard.server->invalidateToolResults(name);
+            }
+        }
+    }
+    /// Notify the sessions of every running shard subscribed to `uri`, see McpServer::notifyResourceUpdated().
+    auto notifyResourceUpdated(std::string_view uri) -> void {
+        std::lock_guard lock(mMutex);
+        for (auto& shard : mShards) {
+            if (shard.server != nullptr) {
+                shard.server->notifyResourceUpdated(uri);
+            }
+        }
+    }
+
+private:
+    struct Shard {
+        ILIAS_NAMESPACE::IoContext* context   = nullptr;
+        ServerT* server                       = nullptr;
+        NEKO_NAMESPACE::SseListener* listener = nullptr;
+    };
+
+    template <typename T>
+    using IoTask = ILIAS_NAMESPACE::IoTask<T>;
+
+    auto _publish_tool(std::string_view name, std::shared_ptr<detail::RpcMethodWrapper> handler) -> bool {
+        if (mRegistries.tools->load()->handlers.contains(name) ||
+            !detail::publish_tool(*mRegistries.tools, *mMetrics, name, std::move(handler))) {
+            return false;
+        }
+        _registries_changed(true, false);
+        return true;
+    }
+    /// The shards already running rebuild their lists, the others read the registry when they start.
+    auto _registries_changed(bool tools, bool resources) -> void {
+        std::lock_guard lock(mMutex);
+        for (auto& shard : mShards) {
+            if (shard.server != nullptr) {
+                shard.server->_registries_changed(tools, resources);
+            }
+        }
+    }
+
+    static auto _close(void* self) -> void {
+        auto* shard = static_cast<Shard*>(self);
+        if (shard->listener != nullptr) {
+            shard->listener->close();
+        }
+        if (shard->server != nullptr) {
+            shard->server->close();
+        }
+    }
+
+    auto _run(std::size_t index) -> void {
+        ILIAS_NAMESPACE::PlatformContext context;
+        context.install();
+        ILIAS_NAMESPACE::spawn(_serve(index, context)).wait();
+    }
+
+    auto _serve(std::size_t index, ILIAS_NAMESPACE::IoContext& context) -> ILIAS_NAMESPACE::Task<void> {
+        std::optional<ServerT> shared;
+        if constexpr (std::is_void_v<ToolFunctions>) {
+            shared.emplace(context, mMetrics, mRegistries);
+        } else {
+            shared.emplace(context, mMetrics, mRegistries, mToolFunctions);
+        }
+        auto& server = *shared;
+        mSetup(server, index);
+        auto listener = co_await mBind(index);
+        if (!listener) {
+            NEKO_LOG_ERROR("mcp server", "shard {} failed to listen: {}", index, listener.error().message());
+            co_return;
+        }
+        NEKO_NAMESPACE::SseListener sse(std::move(*listener), mRouter, index, context);
+        {
+            std::lock_guard lock(mMutex);
+            mShards[index] = Shard{.context = &context, .server = &server, .listener = &sse};
+            // stop() ran before this shard was published, its close was never posted.
+            if (mStopping) {
+                _close(&mShards[index]);
+            }
+        }
+        while (true) {
+            auto stream = co_await sse.accept();
+            if (!stream) {
+                break;
+            }
+            server.addTransport(std::move(*stream));
+        }
+        {
+            std::lock_guard lock(mMutex);
+            mShards[index] = Shard{};
+        }
+        server.close();
+        co_await server.wait();
+    }
+
+    std::shared_ptr<NEKO_NAMESPACE::SseShardRouter> mRouter;
+    std::shared_ptr<MetricsRegistry> mMetrics = std::make_shared<MetricsRegistry>();
+    detail::Registries mRegistries;
+    std::shared_ptr<ToolFunctions> mToolFunctions;
+    std::mutex mMutex;
+    bool mStopping = false; // guarded by mMutex
+    std::vector<Shard> mShards;
+    std::vector<std::thread> mThreads;
+    Setup mSetup;
+    Bind mBind;
+};
+CCMCP_EN
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <ilias/io/error.hpp>
+#include <ilias/task/spawn.hpp>
+#include <ilias/task/task.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief One client connection, its writes are serialized so responses and notifications never interleave.
+ */
+class McpSession : public std::enable_shared_from_this<McpSession> {
+public:
+    template <typename T>
+    using IoTask = ILIAS_NAMESPACE::IoTask<T>;
+
+    explicit McpSession(uint64_t id) noexcept : mId(id) {}
+    McpSession(const McpSession&)            = delete;
+    McpSession& operator=(const McpSession&) = delete;
+    virtual ~McpSession()                    = default;
+
+    auto id() const noexcept -> uint64_t { return mId; }
+    auto isClosed() const noexcept -> bool { return mClosed; }
+    auto markClosed() noexcept -> void { mClosed = true; }
+
+    /// Queue a complete message, the same buffer may be posted to many sessions.
+    auto post(std::shared_ptr<const std::string> message) -> void;
+    auto post(std::string message) -> void { post(std::make_shared<const std::string>(std::move(message))); }
+    /// Write a message now, or behind the write in flight.
+    auto send(std::span<const std::byte> data) -> IoTask<void>;
+
+    /// Requests this session is running outside of JsonRpcServer, keyed by their raw id token. beginRequest() must
+    /// come before the task is spawned, a task that finishes right away calls endRequest() before attachRequest().
+    /// `stop` is requested on cancellation before the task is stopped, for tools that cannot be stopped as a task.
+    auto beginRequest(std::string_view id, std::stop_source stop = std::stop_source(std::nostopstate)) -> void;
+    auto attachRequest(std::string_view id, ILIAS_NAMESPACE::StopHandle handle) -> void;
+    /// Cancel through `onCancel` instead of stopping a task, for requests sharing their execution with others.
+    auto attachRequest(std::string_view id, std::function<void()> onCancel) -> void;
+    auto endRequest(std::string_view id) -> void;
+    auto cancel(std::string_view id) -> bool;
+    auto cancelAll() -> void;
+
+protected:
+    virtual auto write(std::span<const std::byte> data) -> IoTask<void> = 0;
+
+private:
+    struct Inflight {
+        std::stop_source stop{std::nostopstate};
+        ILIAS_NAMESPACE::StopHandle handle;
+        std::function<void()> onCancel;
+
+        auto cancel() -> void;
+    };
+
+    auto _write_pending() -> IoTask<void>;
+    static auto _flush_posted(std::shared_ptr<McpSession> self) -> ILIAS_NAMESPACE::Task<void>;
+
+    uint64_t mId;
+    bool mClosed  = false;
+    bool mWriting = false;
+    std::deque<std::shared_ptr<const std::string>> mPending;
+    std::map<std::string, Inflight, std::less<>> mInflight;
+};
+
+template <typename StreamT>
+class SessionState final : public McpSession {
+public:
+    SessionState(uint64_t id, StreamT stream) : McpSession(id), stream(std::move(stream)) {}
+
+    StreamT stream;
+
+protected:
+    auto write(std::span<const std::byte> data) -> IoTask<void> override { return stream.send(data); }
+};
+
+/**
+ * @brief The endpoint handed to JsonRpcServer, received messages are offered to the server first.
+ */
+template <typename StreamT, typename ServerT>
+class SessionStream {
+public:
+    template <typename T>
+    using IoTask = ILIAS_NAMESPACE::IoTask<T>;
+
+    SessionStream(std::shared_ptr<SessionState<StreamT>> state, ServerT* server)
+        : mState(std::move(state)), mServer(server) {}
+    SessionStream(SessionStream&&) noexcept            = default;
+    SessionStream& operator=(SessionStream&&) noexcept = default;
+    SessionStream(const SessionStream&)                = delete;
+    SessionStream& operator=(const SessionStream&)     = delete;
+
+    auto recv(std::vector<std::byte>& buffer) -> IoTask<void> {
+        if (!mState) {
+            co_return ILIAS_NAMESPACE::Err(ILIAS_NAMESPACE::IoError::Canceled);
+        }
+        while (true) {
+            if (auto ret = co_await mState->stream.recv(buffer); !ret) {
+                co_return ILIAS_NAMESPACE::Err(ret.error());
+            }
+            if (!mServer->_route_message(mState, buffer)) {
+                co_return {};
+            }
+        }
+    }
+    auto send(std::span<const std::byte> data) -> IoTask<void> {
+        if (!mState) {
+            return _canceled();
+        }
+        return mState->send(data);
+    }
+    auto close() -> void {
+        if (!mState) {
+            return;
+        }
+        mState->markClosed();
+        mState->cancelAll();
+        mServer->_close_session(*mState);
+        mState->stream.close();
+    }
+    auto start() -> IoTask<void> {
+        if (!mState) {
+            return _canceled();
+        }
+        return mState->stream.start();
+    }
+    auto shutdown() -> IoTask<void> {
+        if (!mState) {
+            return _canceled();
+        }
+        return mState->stream.shutdown();
+    }
+    auto flush() -> IoTask<void> {
+        if (!mState) {
+            return _canceled();
+        }
+        return mState->stream.flush();
+    }
+
+private:
+    static auto _canceled() -> IoTask<void> { co_return ILIAS_NAMESPACE::Err(ILIAS_NAMESPACE::IoError::Canceled); }
+
+    std::shared_ptr<SessionState<StreamT>> mState;
+    ServerT* mServer = nullptr;
+};
+} // namespace detail
+CCMCP_EN
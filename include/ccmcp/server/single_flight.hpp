@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/server/batch.hpp"
+#include "ccmcp/server/session.hpp"
+
+#include <ilias/task/spawn.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief One tool execution shared by identical concurrent calls, stopped once the last caller is gone.
+ */
+struct SharedToolCall {
+    struct Caller {
+        Responder responder;
+        std::string id;
+    };
+
+    /// canonical key, see ToolResultCache::makeKey()
+    std::string key;
+    std::vector<Caller> callers;
+    std::stop_source stop;
+    ILIAS_NAMESPACE::StopHandle handle;
+
+    auto join(Responder responder, std::string_view id) -> void {
+        callers.push_back(Caller{.responder = std::move(responder), .id = std::string(id)});
+    }
+    /// Remove a caller, true if it was the last one.
+    auto leave(const McpSession& session, std::string_view id) -> bool {
+        std::erase_if(callers, [&](const Caller& caller) {
+            return caller.id == id && caller.responder.session.lock().get() == &session;
+        });
+        return callers.empty();
+    }
+};
+} // namespace detail
+CCMCP_EN
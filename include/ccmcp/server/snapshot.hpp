@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief Read-copy-update cell holding an immutable `T`.
+ *
+ * Readers keep the version they loaded without locking, writers publish a modified copy.
+ */
+template <typename T>
+class SnapshotCell {
+public:
+    SnapshotCell() : mCurrent(std::make_shared<const T>()) {}
+    SnapshotCell(const SnapshotCell&)            = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    auto load() const noexcept -> std::shared_ptr<const T> { return mCurrent.load(std::memory_order_acquire); }
+    /// Bumped on every publish.
+    auto version() const noexcept -> uint64_t { return mVersion.load(std::memory_order_acquire); }
+
+    /// Apply `mutate` to a copy of the current version and publish it, unless `mutate` returns false.
+    template <typename FuncT>
+    auto update(FuncT&& mutate) -> bool {
+        std::lock_guard lock(mWriters);
+        auto next = std::make_shared<T>(*mCurrent.load(std::memory_order_relaxed));
+        if (!std::forward<FuncT>(mutate)(*next)) {
+            return false;
+        }
+        mCurrent.store(std::shared_ptr<const T>(std::move(next)), std::memory_order_release);
+        mVersion.fetch_add(1, std::memory_order_acq_rel);
+        return true;
+    }
+
+private:
+    std::atomic<std::shared_ptr<const T>> mCurrent;
+    std::atomic<uint64_t> mVersion{0};
+    std::mutex mWriters;
+};
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/server/session.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief Sessions subscribed to each resource URI, indexed both ways so a closing session is dropped quickly.
+ */
+class SubscriptionIndex {
+public:
+    auto subscribe(const std::shared_ptr<McpSession>& session, std::string_view uri) -> void;
+    auto unsubscribe(const McpSession& session, std::string_view uri) -> bool;
+    /// Drop every subscription of `session`, returns how many it had.
+    auto removeSession(const McpSession& session) -> std::size_t;
+    /// Post `message` to every live session subscribed to `uri`, the same buffer is shared by all of them. Returns
+    /// the number of sessions it was posted to.
+    auto publish(std::string_view uri, const std::shared_ptr<const std::string>& message) -> std::size_t;
+
+    auto subscribed(std::string_view uri) const -> bool { return mSubscribers.contains(uri); }
+    /// Number of URIs with at least one subscriber.
+    auto size() const noexcept -> std::size_t { return mSubscribers.size(); }
+
+private:
+    auto _erase_subscriber(std::string_view uri, uint64_t session) -> void;
+
+    std::map<std::string, std::vector<std::weak_ptr<McpSession>>, std::less<>> mSubscribers;
+    /// session id -> subscribed URIs
+    std::unordered_map<uint64_t, std::vector<std::string>> mSessions;
+};
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include "ccmcp/model/jsonrpc_protocol.hpp"
+#include "ccmcp/model/model.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief Cached tools/list result, sorted by name, with the serialized JSON of every tool.
+ */
+class ToolCatalog {
+public:
+    struct Snapshot {
+        /// tools sorted by name
+        ToolsListResult result;
+        /// serialized form of every entry of result.tools
+        std::vector<std::string> toolJson;
+        /// the whole list serialized, ready to be spliced into a response
+        std::string json;
+        /// bumped on every rebuild
+        uint64_t version = 0;
+
+        /// Index range of the page following the tool named `after`, `limit` 0 means no limit.
+        auto page(const std::optional<std::string>& after, std::size_t limit) const
+            -> std::pair<std::size_t, std::size_t>;
+        auto pageResult(const std::optional<std::string>& after, std::size_t limit) const -> ToolsListResult;
+        auto pageJson(const std::optional<std::string>& after, std::size_t limit) const -> std::string;
+    };
+
+    /// `registryVersion` is the version of the tool registry the snapshot was built from.
+    auto isStale(uint64_t registryVersion) const noexcept -> bool {
+        return !mSnapshot || mDirty || mRegistryVersion != registryVersion;
+    }
+    auto invalidate() noexcept -> void { mDirty = true; }
+    auto snapshot() const noexcept -> const std::shared_ptr<const Snapshot>& { return mSnapshot; }
+    auto update(ToolsListResult result, uint64_t registryVersion) -> std::shared_ptr<const Snapshot>;
+
+private:
+    std::shared_ptr<const Snapshot> mSnapshot;
+    uint64_t mVersion         = 0;
+    uint64_t mRegistryVersion = 0;
+    bool mDirty               = true;
+};
+} // namespace detail
+CCMCP_EN
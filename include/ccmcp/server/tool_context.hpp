@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <stop_token>
+
+CCMCP_BN
+template <typename ToolFunctions>
+class McpServer;
+
+namespace detail {
+class ProgressReporter;
+
+/// Per call state handed to a tool wrapper.
+struct ToolCallContext {
+    /// Receives the updates of streaming tools, may be null.
+    ProgressReporter* progress = nullptr;
+    /// Requested when the call is cancelled or its deadline expires.
+    std::stop_token stop;
+    /// Server running the call, synchronous tools are offloaded to its executor. Run inline if null.
+    McpServer<void>* server = nullptr;
+};
+
+/// Makes `stop` visible to this_tool while a synchronous tool runs on the current thread.
+class StopTokenScope {
+public:
+    explicit StopTokenScope(std::stop_token stop) noexcept;
+    StopTokenScope(const StopTokenScope&)            = delete;
+    StopTokenScope& operator=(const StopTokenScope&) = delete;
+    ~StopTokenScope();
+
+private:
+    std::stop_token mPrevious;
+};
+} // namespace detail
+
+/**
+ * @brief Cancellation of the synchronous tool running on the calling thread.
+ *
+ * Long loops should poll stop_requested(), outside of a tool the token never stops.
+ */
+namespace this_tool {
+auto stop_token() noexcept -> std::stop_token;
+auto stop_requested() noexcept -> bool;
+} // namespace this_tool
+CCMCP_EN
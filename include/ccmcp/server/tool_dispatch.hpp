@@ -0,0 +1,356 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+CCMCP_BN
+namespace detail {
+/// FNV-1a over the tool name, this is the only pass over the key bytes on lookup.
+constexpr auto tool_name_hash(std::string_view name) noexcept -> uint64_t {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// splitmix64 finalizer, used to derive bucket and slot positions from one name hash.
+constexpr auto mix_hash(uint64_t value) noexcept -> uint64_t {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBULL;
+    value ^= value >> 31;
+    return value;
+}
+
+constexpr auto next_power_of_two(std::size_t value) noexcept -> std::size_t {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Minimal perfect hash (hash and displace) over a fixed set of names, the names must outlive the table.
+ */
+class PerfectHashIndex {
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    constexpr PerfectHashIndex() = default;
+    constexpr explicit PerfectHashIndex(std::span<const std::string_view> names) { build(names); }
+
+    constexpr auto build(std::span<const std::string_view> names) -> bool {
+        mKeys.assign(names.begin(), names.end());
+        mDisplacements.clear();
+        mSlots.clear();
+        if (mKeys.empty()) {
+            return true;
+        }
+        for (std::size_t capacity = next_power_of_two(mKeys.size() + mKeys.size() / 4 + 1); capacity <= (1U << 24);
+             capacity <<= 1) {
+            if (_try_build(capacity)) {
+                return true;
+            }
+        }
+        // Only two names with an identical 64 bit hash can get here.
+        mKeys.clear();
+        mDisplacements.clear();
+        mSlots.clear();
+        return false;
+    }
+
+    /// Index of `name` in the span passed to build(), or npos.
+    constexpr auto find(std::string_view name) const noexcept -> std::size_t {
+        if (mSlots.empty()) {
+            return npos;
+        }
+        const uint64_t hash = tool_name_hash(name);
+        const auto slot     = _slot(hash, mDisplacements[_bucket(hash)]);
+        const auto index    = mSlots[slot];
+        if (index != kEmpty && mKeys[index] == name) {
+            return index;
+        }
+        return npos;
+    }
+
+    constexpr auto size() const noexcept -> std::size_t { return mKeys.size(); }
+    constexpr auto empty() const noexcept -> bool { return mKeys.empty(); }
+    constexpr auto keys() const noexcept -> std::span<const std::string_view> { return mKeys; }
+
+private:
+    static constexpr uint32_t kEmpty = static_cast<uint32_t>(-1);
+
+    constexpr auto _bucket(uint64_t hash) const noexcept -> std::size_t { return mix_hash(hash) % mDisplacements.size(); }
+    constexpr auto _slot(uint64_t hash, uint32_t displacement) const noexcept -> std::size_t {
+        return mix_hash(hash + displacement * 0x9E3779B97F4A7C15ULL) & (mSlots.size() - 1);
+    }
+
+    constexpr auto _try_build(std::size_t capacity) -> bool {
+        const std::size_t bucketCount = std::max<std::size_t>(1, mKeys.size() / 4);
+        mDisplacements.assign(bucketCount, 0);
+        mSlots.assign(capacity, kEmpty);
+
+        std::vector<std::vector<uint32_t>> buckets(bucketCount);
+        std::vector<uint64_t> hashes(mKeys.size());
+        for (uint32_t idx = 0; idx < mKeys.size(); ++idx) {
+            hashes[idx] = tool_name_hash(mKeys[idx]);
+            buckets[_bucket(hashes[idx])].push_back(idx);
+        }
+        // Place the crowded buckets first while the table is still sparse.
+        std::vector<std::size_t> order(bucketCount);
+        for (std::size_t idx = 0; idx < bucketCount; ++idx) {
+            order[idx] = idx;
+        }
+        std::sort(order.begin(), order.end(),
+                  [&](std::size_t lhs, std::size_t rhs) { return buckets[lhs].size() > buckets[rhs].size(); });
+
+        std::vector<std::size_t> placed;
+        for (auto bucketIdx : order) {
+            const auto& bucket = buckets[bucketIdx];
+            if (bucket.empty()) {
+                break;
+            }
+            bool found = false;
+            for (uint32_t displacement = 0; displacement < (1U << 16) && !found; ++displacement) {
+                placed.clear();
+                found = true;
+                for (auto keyIdx : bucket) {
+                    const auto slot = _slot(hashes[keyIdx], displacement);
+                    if (mSlots[slot] != kEmpty) {
+                        found = false;
+                        break;
+                    }
+                    mSlots[slot] = keyIdx;
+                    placed.push_back(slot);
+                }
+                if (found) {
+                    mDisplacements[bucketIdx] = displacement;
+                } else {
+                    for (auto slot : placed) {
+                        mSlots[slot] = kEmpty;
+                    }
+                }
+            }
+            if (!found) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::string_view> mKeys;
+    std::vector<uint32_t> mDisplacements;
+    std::vector<uint32_t> mSlots;
+};
+
+/**
+ * @brief Open addressing hash map keyed by tool name, the keys are owned by the table.
+ */
+template <typename T>
+class FlatToolMap {
+public:
+    FlatToolMap() = default;
+
+    auto find(std::string_view name) noexcept -> T* {
+        return const_cast<T*>(static_cast<const FlatToolMap*>(this)->find(name));
+    }
+    auto find(std::string_view name) const noexcept -> const T* {
+        if (mSize == 0) {
+            return nullptr;
+        }
+        const uint64_t hash = tool_name_hash(name);
+        const auto mask     = mSlots.size() - 1;
+        for (auto idx = static_cast<std::size_t>(hash) & mask;; idx = (idx + 1) & mask) {
+            const auto& slot = mSlots[idx];
+            if (!slot.used) {
+                return nullptr;
+            }
+            if (slot.hash == hash && slot.key == name) {
+                return &slot.value;
+            }
+        }
+    }
+
+    auto insert(std::string_view name, T value) -> bool {
+        if ((mSize + 1) * 4 > mSlots.size() * 3) {
+            _rehash(std::max<std::size_t>(16, mSlots.size() * 2));
+        }
+        const uint64_t hash = tool_name_hash(name);
+        const auto mask     = mSlots.size() - 1;
+        for (auto idx = static_cast<std::size_t>(hash) & mask;; idx = (idx + 1) & mask) {
+            auto& slot = mSlots[idx];
+            if (!slot.used) {
+                slot = Slot{.hash = hash, .key = std::string(name), .value = std::move(value), .used = true};
+                ++mSize;
+                return true;
+            }
+            if (slot.hash == hash && slot.key == name) {
+                return false;
+            }
+        }
+    }
+
+    auto erase(std::string_view name) -> bool {
+        if (mSize == 0) {
+            return false;
+        }
+        const uint64_t hash = tool_name_hash(name);
+        const auto mask     = mSlots.size() - 1;
+        auto idx            = static_cast<std::size_t>(hash) & mask;
+        for (;; idx = (idx + 1) & mask) {
+            if (!mSlots[idx].used) {
+                return false;
+            }
+            if (mSlots[idx].hash == hash && mSlots[idx].key == name) {
+                break;
+            }
+        }
+        // Backward shift deletion keeps probe chains intact without tombstones.
+        for (auto next = (idx + 1) & mask; mSlots[next].used; next = (next + 1) & mask) {
+            const auto home = static_cast<std::size_t>(mSlots[next].hash) & mask;
+            if (((next - home) & mask) >= ((next - idx) & mask)) {
+                mSlots[idx] = std::move(mSlots[next]);
+                idx         = next;
+            }
+        }
+        mSlots[idx] = Slot{};
+        --mSize;
+        return true;
+    }
+
+    template <typename FuncT>
+    auto forEach(FuncT&& func) const -> void {
+        for (const auto& slot : mSlots) {
+            if (slot.used) {
+                func(std::string_view(slot.key), slot.value);
+            }
+        }
+    }
+
+    auto size() const noexcept -> std::size_t { return mSize; }
+    auto empty() const noexcept -> bool { return mSize == 0; }
+
+private:
+    struct Slot {
+        uint64_t hash = 0;
+        std::string key;
+        T value{};
+        bool used = false;
+    };
+
+    auto _rehash(std::size_t capacity) -> void {
+        auto old = std::exchange(mSlots, std::vector<Slot>(capacity));
+        mSize    = 0;
+        for (auto& slot : old) {
+            if (slot.used) {
+                insert(slot.key, std::move(slot.value));
+            }
+        }
+    }
+
+    std::vector<Slot> mSlots;
+    std::size_t mSize = 0;
+};
+
+/**
+ * @brief tools/call dispatch table.
+ *
+ * ToolFunctions members are served by a perfect hash, tools added with registerToolFunction by a FlatToolMap.
+ */
+template <typename HandlerT>
+class ToolDispatchTable {
+public:
+    ToolDispatchTable() = default;
+
+    auto setStatic(std::vector<std::string_view> names, std::vector<std::shared_ptr<HandlerT>> handlers) -> bool {
+        if (names.size() != handlers.size()) {
+            return false;
+        }
+        mStaticNames    = std::move(names);
+        mStaticHandlers = std::move(handlers);
+        if (!mStaticIndex.build(mStaticNames)) {
+            // Degrade to the flat map rather than refusing to serve the tools.
+            for (std::size_t idx = 0; idx < mStaticNames.size(); ++idx) {
+                mDynamicHandlers.insert(mStaticNames[idx], std::move(mStaticHandlers[idx]));
+            }
+            mStaticNames.clear();
+            mStaticHandlers.clear();
+            return false;
+        }
+        return true;
+    }
+
+    auto insert(std::string_view name, std::shared_ptr<HandlerT> handler) -> bool {
+        if (mStaticIndex.find(name) != PerfectHashIndex::npos) {
+            return false;
+        }
+        return mDynamicHandlers.insert(name, std::move(handler));
+    }
+
+    /// Swap the handler of a registered tool, the previous one stays alive for the copies still serving it.
+    auto replace(std::string_view name, std::shared_ptr<HandlerT> handler) -> bool {
+        if (auto idx = mStaticIndex.find(name); idx != PerfectHashIndex::npos) {
+            mStaticHandlers[idx] = std::move(handler);
+            return true;
+        }
+        if (auto* slot = mDynamicHandlers.find(name); slot != nullptr) {
+            *slot = std::move(handler);
+            return true;
+        }
+        return false;
+    }
+
+    auto erase(std::string_view name) -> bool { return mDynamicHandlers.erase(name); }
+
+    auto find(std::string_view name) const noexcept -> HandlerT* {
+        const auto* slot = _slot(name);
+        return slot ? slot->get() : nullptr;
+    }
+    /// Like find(), for callers that keep using the handler after dropping the table.
+    auto get(std::string_view name) const noexcept -> std::shared_ptr<HandlerT> {
+        const auto* slot = _slot(name);
+        return slot ? *slot : nullptr;
+    }
+
+    /// Call `func(name, handler)` for every tool, the static ones first.
+    template <typename FuncT>
+    auto forEach(FuncT&& func) const -> void {
+        for (std::size_t idx = 0; idx < mStaticNames.size(); ++idx) {
+            func(mStaticNames[idx], *mStaticHandlers[idx]);
+        }
+        mDynamicHandlers.forEach([&](std::string_view name, const std::shared_ptr<HandlerT>& handler) {
+            func(name, *handler);
+        });
+    }
+
+    auto contains(std::string_view name) const noexcept -> bool { return _slot(name) != nullptr; }
+    auto size() const noexcept -> std::size_t { return mStaticHandlers.size() + mDynamicHandlers.size(); }
+
+private:
+    auto _slot(std::string_view name) const noexcept -> const std::shared_ptr<HandlerT>* {
+        if (auto idx = mStaticIndex.find(name); idx != PerfectHashIndex::npos) {
+            return &mStaticHandlers[idx];
+        }
+        return mDynamicHandlers.find(name);
+    }
+
+    std::vector<std::string_view> mStaticNames;
+    std::vector<std::shared_ptr<HandlerT>> mStaticHandlers;
+    PerfectHashIndex mStaticIndex;
+    FlatToolMap<std::shared_ptr<HandlerT>> mDynamicHandlers;
+};
+} // namespace detail
+CCMCP_EN
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <ilias/io/context.hpp>
+#include <ilias/io/error.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+CCMCP_BN
+/**
+ * @brief Thread pool for synchronous tools, the awaiting coroutine is resumed on its IoContext.
+ */
+class ToolExecutor {
+public:
+    explicit ToolExecutor(std::size_t threads = std::thread::hardware_concurrency());
+    ToolExecutor(const ToolExecutor&)            = delete;
+    ToolExecutor& operator=(const ToolExecutor&) = delete;
+    ~ToolExecutor();
+
+    auto post(std::function<void()> job) -> void;
+    auto threadCount() const noexcept -> std::size_t { return mThreads.size(); }
+
+private:
+    auto _worker() -> void;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::function<void()>> mJobs;
+    std::vector<std::thread> mThreads;
+    bool mStopping = false;
+};
+
+namespace detail {
+/**
+ * @brief Awaiter of offload().
+ *
+ * A call stopped through `stop` is resumed right away with IoError::Canceled and the job is detached.
+ */
+template <typename FuncT>
+class OffloadAwaiter {
+public:
+    using ResultT = std::invoke_result_t<FuncT&>;
+
+    OffloadAwaiter(ToolExecutor& executor, ILIAS_NAMESPACE::IoContext& context, FuncT func, std::stop_token stop)
+        : mExecutor(executor), mState(std::make_shared<State>(context, std::move(func))), mStop(std::move(stop)) {}
+
+    auto await_ready() const noexcept -> bool { return false; }
+    auto await_suspend(std::coroutine_handle<> handle) -> void {
+        mState->handle = handle;
+        mExecutor.post([state = mState]() {
+            if (state->claimed.load(std::memory_order_acquire)) {
+                return;
+            }
+            try {
+                if constexpr (std::is_void_v<ResultT>) {
+                    state->func();
+                } else {
+                    state->result.emplace(state->func());
+                }
+            } catch (...) {
+                state->exception = std::current_exception();
+            }
+            if (!state->claimed.exchange(true, std::memory_order_acq_rel)) {
+                state->context.post(&OffloadAwaiter::_resume, state->handle.address());
+            }
+        });
+        // Registered after the job is posted, a stop already requested claims the state here.
+        if (mStop.stop_possible()) {
+            mCanceler.emplace(mStop, Canceler{mState});
+        }
+    }
+    auto await_resume() -> ILIAS_NAMESPACE::IoResult<ResultT> {
+        mCanceler.reset();
+        if (mState->canceled) {
+            return ILIAS_NAMESPACE::Err(ILIAS_NAMESPACE::IoError::Canceled);
+        }
+        if (mState->exception) {
+            std::rethrow_exception(mState->exception);
+        }
+        if constexpr (std::is_void_v<ResultT>) {
+            return {};
+        } else {
+            return std::move(*mState->result);
+        }
+    }
+
+private:
+    struct State {
+        State(ILIAS_NAMESPACE::IoContext& context, FuncT func) : context(context), func(std::move(func)) {}
+
+        ILIAS_NAMESPACE::IoContext& context;
+        FuncT func;
+        std::conditional_t<std::is_void_v<ResultT>, bool, std::optional<ResultT>> result{};
+        std::exception_ptr exception;
+        std::coroutine_handle<> handle;
+        std::atomic<bool> claimed{false};
+        /// Set before the resume is posted by the stop, read after it.
+        bool canceled = false;
+    };
+
+    struct Canceler {
+        std::shared_ptr<State> state;
+
+        auto operator()() noexcept -> void {
+            if (!state->claimed.exchange(true, std::memory_order_acq_rel)) {
+                state->canceled = true;
+                // The stop may be requested from inside another coroutine, or from another thread.
+                state->context.post(&OffloadAwaiter::_resume, state->handle.address());
+            }
+        }
+    };
+
+    static auto _resume(void* address) -> void { std::coroutine_handle<>::from_address(address).resume(); }
+
+    ToolExecutor& mExecutor;
+    std::shared_ptr<State> mState;
+    std::stop_token mStop;
+    std::optional<std::stop_callback<Canceler>> mCanceler;
+};
+} // namespace detail
+
+/// Run `func` on `executor` and resume the awaiting coroutine on `context`. Once `stop` is requested the coroutine
+/// resumes with IoError::Canceled without waiting for `func`.
+template <typename FuncT>
+auto offload(ToolExecutor& executor, ILIAS_NAMESPACE::IoContext& context, FuncT func, std::stop_token stop = {}) {
+    return detail::OffloadAwaiter<FuncT>(executor, context, std::move(func), std::move(stop));
+}
+CCMCP_EN
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <ilias/io/context.hpp>
+#include <ilias/io/error.hpp>
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <stop_token>
+#include <utility>
+
+CCMCP_BN
+namespace detail {
+/**
+ * @brief Admission control of one tool.
+ *
+ * tryAdmit() reserves a place or fails fast, acquire() waits for a running slot. Call wake() after raising the limits.
+ */
+class ToolLimiter {
+public:
+    /// A reserved place, given back when destroyed unless it became a running slot.
+    class Admission {
+    public:
+        Admission() noexcept = default;
+        explicit Admission(ToolLimiter& limiter) noexcept : mLimiter(&limiter) {}
+        Admission(Admission&& other) noexcept : mLimiter(std::exchange(other.mLimiter, nullptr)) {}
+        Admission& operator=(Admission&&) = delete;
+        ~Admission() { reset(); }
+
+        explicit operator bool() const noexcept { return mLimiter != nullptr; }
+        auto reset() noexcept -> void {
+            if (auto* limiter = std::exchange(mLimiter, nullptr); limiter != nullptr) {
+                --limiter->mAdmitted;
+            }
+        }
+
+    private:
+        friend class ToolLimiter;
+        ToolLimiter* mLimiter = nullptr;
+    };
+
+    /// A running slot, given back when destroyed.
+    class Permit {
+    public:
+        Permit(ToolLimiter& limiter, ILIAS_NAMESPACE::IoContext& context, std::size_t maxConcurrency) noexcept
+            : mLimiter(&limiter), mContext(&context), mMaxConcurrency(maxConcurrency) {}
+        Permit(Permit&& other) noexcept
+            : mLimiter(std::exchange(other.mLimiter, nullptr)), mContext(other.mContext),
+              mMaxConcurrency(other.mMaxConcurrency) {}
+        Permit& operator=(Permit&&) = delete;
+        ~Permit() {
+            if (mLimiter != nullptr) {
+                mLimiter->_release(*mContext, mMaxConcurrency);
+            }
+        }
+
+    private:
+        ToolLimiter* mLimiter;
+        ILIAS_NAMESPACE::IoContext* mContext;
+        std::size_t mMaxConcurrency;
+    };
+
+    /// Ends with IoError::Canceled once `stop` is requested while the call is still queued.
+    class AcquireAwaiter {
+    public:
+        AcquireAwaiter(Admission admission, ILIAS_NAMESPACE::IoContext& context, std::size_t maxConcurrency,
+                       std::stop_token stop) noexcept
+            : mLimiter(*admission.mLimiter), mAdmission(std::move(admission)), mContext(context),
+              mMaxConcurrency(maxConcurrency), mStop(std::move(stop)) {}
+        AcquireAwaiter(const AcquireAwaiter&) = delete;
+        ~AcquireAwaiter();
+
+        auto await_ready() noexcept -> bool;
+        auto await_suspend(std::coroutine_handle<> handle) -> void;
+        auto await_resume() noexcept -> ILIAS_NAMESPACE::IoResult<Permit>;
+
+    private:
+        friend class ToolLimiter;
+
+        struct Canceler {
+            AcquireAwaiter* self;
+
+            auto operator()() noexcept -> void { self->_cancel(); }
+        };
+
+        auto _grant() noexcept -> void;
+        auto _cancel() noexcept -> void;
+
+        ToolLimiter& mLimiter;
+        Admission mAdmission;
+        ILIAS_NAMESPACE::IoContext& mContext;
+        std::size_t mMaxConcurrency;
+        std::stop_token mStop;
+        std::coroutine_handle<> mHandle;
+        bool mQueued  = false;
+        bool mGranted = false;
+        std::optional<std::stop_callback<Canceler>> mCanceler;
+    };
+
+    /// Reserve a place for one call, empty if it must be rejected.
+    auto tryAdmit(std::size_t maxConcurrency, std::size_t maxQueue) noexcept -> Admission;
+    /// Wait for a running slot with the place reserved by tryAdmit().
+    auto acquire(Admission admission, ILIAS_NAMESPACE::IoContext& context, std::size_t maxConcurrency,
+                 std::stop_token stop = {}) noexcept -> AcquireAwaiter {
+        return {std::move(admission), context, maxConcurrency, std::move(stop)};
+    }
+    /// Resume as many waiters as the current limit allows.
+    auto wake(ILIAS_NAMESPACE::IoContext& context, std::size_t maxConcurrency) -> void;
+
+    auto running() const noexcept -> std::size_t { return mRunning; }
+    auto queued() const noexcept -> std::size_t { return mAdmitted - mRunning; }
+
+private:
+    /// Give back a running slot, the next waiter is resumed through `context`.
+    auto _release(ILIAS_NAMESPACE::IoContext& context, std::size_t maxConcurrency) -> void;
+    static auto _resume(void* address) -> void { std::coroutine_handle<>::from_address(address).resume(); }
+
+    std::size_t mAdmitted = 0;
+    std::size_t mRunning  = 0;
+    std::deque<AcquireAwaiter*> mWaiters;
+};
+} // namespace detail
+CCMCP_EN
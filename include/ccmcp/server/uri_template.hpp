@@ -0,0 +1,86 @@
+#pragma once
+
+#include "ccmcp/global/global.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+CCMCP_BN
+/// Variables extracted from a URI by a resource template, percent-decoded.
+using UriVariables = std::map<std::string, std::string, std::less<>>;
+
+namespace detail {
+/**
+ * @brief Matches URIs against many RFC 6570 templates at once.
+ *
+ * Supports literal segments, `{var}`, `{var:int}`, `{var}` between a literal prefix and suffix, and a trailing
+ * `{+var}`. A literal wins over an affix capture (longest prefix first), then a whole segment capture, then `{+var}`.
+ * Other RFC 6570 operators are rejected by insert().
+ */
+class UriTemplateMatcher {
+public:
+    struct Match {
+        /// value given to insert()
+        std::size_t value = 0;
+        UriVariables variables;
+    };
+
+    /// Compile `uriTemplate` and map it to `value`. False if the template is malformed or an equivalent one (same
+    /// shape, whatever its variable names) is already registered.
+    auto insert(std::string_view uriTemplate, std::size_t value) -> bool;
+    auto match(std::string_view uri) const -> std::optional<Match>;
+    auto size() const noexcept -> std::size_t { return mSize; }
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+
+        auto operator()(std::string_view str) const noexcept -> std::size_t {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+    struct Terminal {
+        std::size_t value = 0;
+        /// variable names in capture order
+        std::vector<std::string> names;
+    };
+    struct Affix {
+        std::string suffix;
+        bool integer  = false;
+        uint32_t node = 0;
+    };
+    /// Nodes refer to each other by index so the whole matcher is copyable, it lives in a snapshot registry.
+    struct Node {
+        std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> literals;
+        /// keyed by prefix, every bucket in match order
+        std::unordered_map<std::string, std::vector<Affix>, StringHash, std::equal_to<>> affixes;
+        /// lengths of the keys of `affixes`, longest first
+        std::vector<std::size_t> prefixLengths;
+        std::optional<uint32_t> integer;
+        std::optional<uint32_t> capture;
+        std::optional<Terminal> tail;
+        std::optional<Terminal> terminal;
+    };
+
+    auto _add_node() -> uint32_t;
+    auto _add_affix(uint32_t node, std::string_view prefix, std::string_view suffix, bool integer) -> uint32_t;
+    auto _match(uint32_t node, std::string_view uri, std::size_t pos, std::vector<std::string_view>& captures) const
+        -> const Terminal*;
+
+    std::vector<Node> mNodes{Node{}};
+    std::size_t mSize = 0;
+};
+
+/// Decode %XX escapes, malformed escapes are kept as they are.
+auto percent_decode(std::string_view text) -> std::string;
+/// Append `text` to `out` with every byte outside the unreserved set of RFC 3986, and not in `keep`, as %XX.
+auto append_percent_encoded(std::string& out, std::string_view text, std::string_view keep = {}) -> void;
+} // namespace detail
+CCMCP_EN
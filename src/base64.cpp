@@ -0,0 +1,170 @@
+#include "ccmcp/server/base64.hpp"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CCMCP_BASE64_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(CCMCP_BASE64_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CCMCP_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CCMCP_TARGET(isa)
+#endif
+
+CCMCP_BN
+
+namespace {
+constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+using EncodeFunction = void (*)(const unsigned char* src, std::size_t size, char* dst) noexcept;
+
+auto encode_scalar(const unsigned char* src, std::size_t size, char* dst) noexcept -> void {
+    const std::size_t end = size - size % 3;
+    for (std::size_t idx = 0; idx < end; idx += 3, dst += 4) {
+        const uint32_t word = (uint32_t(src[idx]) << 16) | (uint32_t(src[idx + 1]) << 8) | src[idx + 2];
+        dst[0]              = kAlphabet[word >> 18];
+        dst[1]              = kAlphabet[(word >> 12) & 0x3F];
+        dst[2]              = kAlphabet[(word >> 6) & 0x3F];
+        dst[3]              = kAlphabet[word & 0x3F];
+    }
+    if (const auto rest = size - end; rest != 0) {
+        const uint32_t word = (uint32_t(src[end]) << 16) | (rest == 2 ? uint32_t(src[end + 1]) << 8 : 0);
+        dst[0]              = kAlphabet[word >> 18];
+        dst[1]              = kAlphabet[(word >> 12) & 0x3F];
+        dst[2]              = rest == 2 ? kAlphabet[(word >> 6) & 0x3F] : '=';
+        dst[3]              = '=';
+    }
+}
+
+#if defined(CCMCP_BASE64_X86)
+// Both SIMD encoders follow Muła and Lemire, "Faster Base64 Encoding and Decoding using AVX2 Instructions": every
+// 3 input bytes are spread over 4 bytes of a lane, the 6-bit indices are moved into place with two multiplies, and
+// the index is turned into ASCII by adding an offset looked up from its range.
+
+CCMCP_TARGET("ssse3")
+auto indices_to_ascii(__m128i indices) noexcept -> __m128i {
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    range         = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+CCMCP_TARGET("ssse3")
+auto split_indices(__m128i in) noexcept -> __m128i {
+    in             = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const auto hi  = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+    const auto low = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(hi, low);
+}
+
+CCMCP_TARGET("ssse3")
+auto encode_ssse3(const unsigned char* src, std::size_t size, char* dst) noexcept -> void {
+    // 12 bytes are encoded per step but 16 are loaded, stop while 4 spare bytes are left.
+    std::size_t idx = 0;
+    for (; idx + 16 <= size; idx += 12, dst += 16) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + idx));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), indices_to_ascii(split_indices(in)));
+    }
+    encode_scalar(src + idx, size - idx, dst);
+}
+
+CCMCP_TARGET("avx2")
+auto encode_avx2(const unsigned char* src, std::size_t size, char* dst) noexcept -> void {
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, //
+                                             1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                             'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    // 24 bytes per step, one 16 byte load per lane, the upper one ends 28 bytes in.
+    std::size_t idx = 0;
+    for (; idx + 28 <= size; idx += 24, dst += 32) {
+        const __m128i low  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + idx));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + idx + 12));
+        __m256i in         = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        in                 = _mm256_shuffle_epi8(in, shuffle);
+        const auto hi =
+            _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+        const auto lo =
+            _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(hi, lo);
+        __m256i range         = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        range                 = _mm256_or_si256(
+            range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+        const __m256i ascii = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), ascii);
+    }
+    encode_ssse3(src + idx, size - idx, dst);
+}
+
+auto cpu_has(bool avx2) noexcept -> bool {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    if (!avx2) {
+        return (info[2] & (1 << 9)) != 0;
+    }
+    // AVX2 needs the OS to save the YMM registers as well.
+    if (maxLeaf < 7 || (info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return avx2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("ssse3");
+#endif
+}
+#endif
+
+struct Encoder {
+    EncodeFunction encode;
+    std::string_view name;
+};
+
+auto select_encoder() noexcept -> Encoder {
+#if defined(CCMCP_BASE64_X86)
+    if (cpu_has(true)) {
+        return {&encode_avx2, "avx2"};
+    }
+    if (cpu_has(false)) {
+        return {&encode_ssse3, "ssse3"};
+    }
+#endif
+    return {&encode_scalar, "scalar"};
+}
+
+auto encoder() noexcept -> const Encoder& {
+    static const Encoder selected = select_encoder();
+    return selected;
+}
+} // namespace
+
+namespace detail {
+auto base64_encode(std::span<const std::byte> data, char* out) noexcept -> void {
+    encoder().encode(reinterpret_cast<const unsigned char*>(data.data()), data.size(), out);
+}
+
+auto base64_encode_scalar(std::span<const std::byte> data, char* out) noexcept -> void {
+    encode_scalar(reinterpret_cast<const unsigned char*>(data.data()), data.size(), out);
+}
+
+auto base64_append(std::string& out, std::span<const std::byte> data) -> void {
+    const auto offset = out.size();
+    out.resize(offset + base64_encoded_size(data.size()));
+    base64_encode(data, out.data() + offset);
+}
+
+auto base64_implementation() noexcept -> std::string_view { return encoder().name; }
+} // namespace detail
+
+CCMCP_EN
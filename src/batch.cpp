@@ -0,0 +1,58 @@
+#include "ccmcp/server/batch.hpp"
+
+CCMCP_BN
+
+namespace detail {
+auto BatchReply::set(std::size_t index, std::string response) -> void { _settle(index, std::move(response)); }
+
+auto BatchReply::skip(std::size_t index) -> void { _settle(index, std::nullopt); }
+
+auto BatchReply::_settle(std::size_t index, std::optional<std::string> response) -> void {
+    if (index >= mSlots.size() || mSlots[index].settled) {
+        return;
+    }
+    mSlots[index] = Slot{.settled = true, .response = std::move(response)};
+    if (--mRemaining != 0) {
+        return;
+    }
+    auto session = mSession.lock();
+    if (!session) {
+        return;
+    }
+    std::size_t size = 2;
+    for (const auto& slot : mSlots) {
+        size += slot.response ? slot.response->size() + 1 : 0;
+    }
+    std::string message;
+    message.reserve(size);
+    message.push_back('[');
+    for (const auto& slot : mSlots) {
+        if (slot.response) {
+            if (message.size() > 1) {
+                message.push_back(',');
+            }
+            message.append(*slot.response);
+        }
+    }
+    message.push_back(']');
+    if (message.size() > 2) {
+        session->post(std::move(message));
+    }
+}
+
+auto Responder::reply(std::string message) const -> void {
+    if (batch) {
+        batch->set(index, std::move(message));
+    } else if (auto ptr = session.lock(); ptr) {
+        ptr->post(std::move(message));
+    }
+}
+
+auto Responder::drop() const -> void {
+    if (batch) {
+        batch->skip(index);
+    }
+}
+} // namespace detail
+
+CCMCP_EN
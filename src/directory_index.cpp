@@ -0,0 +1,172 @@
+#include "ccmcp/server/directory_index.hpp"
+
+#include "ccmcp/server/uri_template.hpp"
+
+#include <algorithm>
+#include <map>
+#include <system_error>
+#include <utility>
+
+CCMCP_BN
+
+namespace {
+auto split_path(std::string_view path) -> std::vector<std::string_view> {
+    std::vector<std::string_view> parts;
+    while (!path.empty()) {
+        const auto pos = path.find('/');
+        parts.push_back(path.substr(0, pos));
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        path.remove_prefix(pos + 1);
+    }
+    return parts;
+}
+} // namespace
+
+namespace detail {
+DirectoryIndex::DirectoryIndex(std::filesystem::path root, FileResourceOptions options) : mOptions(options) {
+    std::error_code ec;
+    mRoot = std::filesystem::weakly_canonical(root, ec);
+    if (ec) {
+        mRoot = std::filesystem::absolute(root, ec).lexically_normal();
+    }
+    auto generic = mRoot.generic_string();
+    if (!generic.empty() && generic.back() == '/') {
+        generic.pop_back();
+    }
+    // Encoded like the relative paths, so a name holding '#', '%' or a space round trips through resolve().
+    mUriPrefix = "file://";
+    append_percent_encoded(mUriPrefix, generic, "/:");
+    mUriPrefix.push_back('/');
+    mTree.directory = true;
+}
+
+auto DirectoryIndex::list(std::string_view after, std::size_t limit, std::vector<Resource>& out, std::string& last)
+    -> bool {
+    std::string relative;
+    const auto parts = split_path(after);
+    std::lock_guard lock(mMutex);
+    return _list(mTree, relative, parts, limit, out, last);
+}
+
+auto DirectoryIndex::resolve(std::string_view uri) const -> std::optional<LocalFileResource> {
+    if (!uri.starts_with(mUriPrefix) || uri.size() == mUriPrefix.size()) {
+        return std::nullopt;
+    }
+    std::error_code ec;
+    const auto name = percent_decode(uri.substr(mUriPrefix.size()));
+    // Canonical, so neither ".." nor a symbolic link can lead out of the root.
+    auto path = std::filesystem::weakly_canonical(mRoot / std::filesystem::path(name), ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto relative = path.lexically_relative(mRoot);
+    if (relative.empty() || *relative.begin() == "..") {
+        return std::nullopt;
+    }
+    auto mimeType = file_mime_type(path);
+    return LocalFileResource{.path     = std::move(path),
+                             .mimeType = std::move(mimeType),
+                             .maxSize  = mOptions.maxSize,
+                             .mapped   = mOptions.mapped};
+}
+
+auto DirectoryIndex::_scan(Node& dir, const std::filesystem::path& path) -> void {
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (dir.scanned && !ec && dir.mtime == mtime) {
+        return;
+    }
+    // Subdirectories keep their own index, files are stat'ed again since the directory changed.
+    std::map<std::string, std::unique_ptr<Node>, std::less<>> subdirectories;
+    for (auto& child : dir.children) {
+        if (child->directory) {
+            subdirectories.emplace(child->name, std::move(child));
+        }
+    }
+    dir.children.clear();
+    std::filesystem::directory_iterator it(path, std::filesystem::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        std::error_code status_ec;
+        const auto status = it->symlink_status(status_ec);
+        if (status_ec || (!std::filesystem::is_directory(status) && !std::filesystem::is_regular_file(status))) {
+            continue;
+        }
+        auto name            = it->path().filename().string();
+        const bool directory = std::filesystem::is_directory(status);
+        if (auto old = subdirectories.find(name); directory && old != subdirectories.end()) {
+            dir.children.push_back(std::move(old->second));
+            continue;
+        }
+        auto node       = std::make_unique<Node>();
+        node->name      = std::move(name);
+        node->directory = directory;
+        dir.children.push_back(std::move(node));
+    }
+    std::sort(dir.children.begin(), dir.children.end(),
+              [](const std::unique_ptr<Node>& lhs, const std::unique_ptr<Node>& rhs) { return lhs->name < rhs->name; });
+    dir.scanned = true;
+    dir.mtime   = mtime;
+}
+
+auto DirectoryIndex::_list(Node& dir, std::string& relative, std::span<const std::string_view> after,
+                           std::size_t limit, std::vector<Resource>& out, std::string& last) -> bool {
+    _scan(dir, relative.empty() ? mRoot : mRoot / relative);
+    auto enter = [&](Node& child, std::span<const std::string_view> rest) {
+        const auto length = relative.size();
+        relative.append(child.name).push_back('/');
+        const bool more = _list(child, relative, rest, limit, out, last);
+        relative.resize(length);
+        return more;
+    };
+    auto it = dir.children.begin();
+    if (!after.empty()) {
+        it = std::lower_bound(dir.children.begin(), dir.children.end(), after.front(),
+                              [](const std::unique_ptr<Node>& node, std::string_view key) { return node->name < key; });
+        if (it != dir.children.end() && (*it)->name == after.front()) {
+            // Resume inside the directory holding the previous page's last file, or right after that file.
+            if ((*it)->directory && after.size() > 1 && enter(**it, after.subspan(1))) {
+                return true;
+            }
+            ++it;
+        }
+    }
+    for (; it != dir.children.end(); ++it) {
+        auto& child = **it;
+        if (child.directory) {
+            if (enter(child, {})) {
+                return true;
+            }
+            continue;
+        }
+        if (limit != 0 && out.size() >= limit) {
+            return true;
+        }
+        last = relative + child.name;
+        out.push_back(_resource(child, last));
+    }
+    return false;
+}
+
+auto DirectoryIndex::_resource(Node& file, const std::string& relative) -> Resource {
+    // A file written in place does not touch its directory, its size is read again once its own mtime moved.
+    std::error_code ec;
+    const auto path  = mRoot / relative;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (!file.size || ec || file.mtime != mtime) {
+        const auto size = std::filesystem::file_size(path, ec);
+        file.size       = ec ? 0 : size;
+        file.mtime      = mtime;
+    }
+    auto uri = mUriPrefix;
+    append_percent_encoded(uri, relative, "/");
+    Resource resource;
+    resource.uri      = std::move(uri);
+    resource.name     = relative;
+    resource.metadata = ResourceMetadata{.type = "file", .size = static_cast<int64_t>(*file.size)};
+    return resource;
+}
+} // namespace detail
+
+CCMCP_EN
@@ -0,0 +1,185 @@
+#include "ccmcp/server/file_cache.hpp"
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <iterator>
+#include <system_error>
+
+CCMCP_BN
+
+namespace detail {
+FileContentCache::~FileContentCache() {
+#if defined(__linux__)
+    if (mNotify >= 0) {
+        ::close(mNotify);
+    }
+#endif
+}
+
+auto FileContentCache::setCapacity(std::size_t bytes) -> void {
+    mCapacity = bytes;
+    _evict();
+}
+
+auto FileContentCache::invalidate(std::string_view path) -> bool {
+    auto it = mIndex.find(path);
+    if (it == mIndex.end()) {
+        return false;
+    }
+    _erase(it->second);
+    return true;
+}
+
+auto FileContentCache::clear() -> void {
+    while (!mEntries.empty()) {
+        _erase(mEntries.begin());
+    }
+}
+
+auto FileContentCache::_find(const std::string& path) -> std::shared_ptr<const std::string> {
+    if (!enabled()) {
+        return nullptr;
+    }
+    _poll_events();
+    auto it = mIndex.find(path);
+    if (it == mIndex.end()) {
+        ++mMisses;
+        return nullptr;
+    }
+    if (auto entry = it->second; entry->watch < 0) {
+        if (auto stamp = _stamp(path); !stamp || *stamp != entry->stamp) {
+            _erase(entry);
+            ++mMisses;
+            return nullptr;
+        }
+    }
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    ++mHits;
+    return mEntries.front().payload;
+}
+
+auto FileContentCache::_insert(std::string path, std::shared_ptr<const std::string> payload, const Stamp& stamp,
+                               int watch) -> void {
+    if (!enabled() || path.size() + payload->size() + sizeof(Entry) > mCapacity) {
+        _unwatch(watch);
+        return;
+    }
+    if (auto it = mIndex.find(path); it != mIndex.end()) {
+        if (it->second->watch == watch) {
+            // Keep the watch, the new entry takes it over.
+            it->second->watch = -1;
+        }
+        _erase(it->second);
+    }
+    mEntries.push_front(Entry{.path = std::move(path), .payload = std::move(payload), .stamp = stamp, .watch = watch});
+    mBytes += mEntries.front().cost();
+    mIndex.emplace(mEntries.front().path, mEntries.begin());
+    _evict();
+}
+
+auto FileContentCache::_watch(const std::string& path) -> int {
+#if defined(__linux__)
+    if (!enabled()) {
+        return -1;
+    }
+    if (mNotify < 0 && !mNotifyFailed) {
+        mNotify       = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        mNotifyFailed = mNotify < 0;
+    }
+    if (mNotify < 0) {
+        return -1;
+    }
+    constexpr uint32_t kMask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF;
+    const int watch          = ::inotify_add_watch(mNotify, path.c_str(), kMask);
+    if (watch < 0) {
+        return -1;
+    }
+    // A hard link to a file already watched under another path gives the same descriptor, such an entry falls back
+    // to its stamp rather than sharing the watch.
+    if (auto [it, inserted] = mWatches.try_emplace(watch, path); !inserted && it->second != path) {
+        return -1;
+    }
+    return watch;
+#else
+    (void)path;
+    return -1;
+#endif
+}
+
+auto FileContentCache::_unwatch(int watch) -> void {
+#if defined(__linux__)
+    if (watch >= 0 && mWatches.erase(watch) != 0) {
+        ::inotify_rm_watch(mNotify, watch);
+    }
+#else
+    (void)watch;
+#endif
+}
+
+auto FileContentCache::_poll_events() -> void {
+#if defined(__linux__)
+    if (mNotify < 0) {
+        return;
+    }
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        const auto length = ::read(mNotify, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost, nothing cached can be trusted.
+                clear();
+                continue;
+            }
+            auto watch = mWatches.find(event->wd);
+            if (watch == mWatches.end()) {
+                continue;
+            }
+            if (auto it = mIndex.find(watch->second); it != mIndex.end()) {
+                _erase(it->second);
+            } else if (event->mask & IN_IGNORED) {
+                // The kernel removed the watch itself (file deleted), the descriptor may be reused.
+                mWatches.erase(watch);
+            } else {
+                _unwatch(event->wd);
+            }
+        }
+    }
+#endif
+}
+
+auto FileContentCache::_stamp(const std::string& path) -> std::optional<Stamp> {
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return Stamp{.mtime = mtime, .size = size};
+}
+
+auto FileContentCache::_erase(List::iterator it) -> void {
+    _unwatch(it->watch);
+    mBytes -= it->cost();
+    mIndex.erase(it->path);
+    mEntries.erase(it);
+}
+
+auto FileContentCache::_evict() -> void {
+    while (mBytes > mCapacity && !mEntries.empty()) {
+        _erase(std::prev(mEntries.end()));
+    }
+}
+} // namespace detail
+
+CCMCP_EN
@@ -0,0 +1,539 @@
+#include "ccmcp/server/file_resource.hpp"
+
+#include "ccmcp/model/raw_message.hpp"
+#include "ccmcp/server/base64.hpp"
+
+#include <nekoproto/global/log.hpp>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+CCMCP_BN
+
+namespace {
+auto to_lower(std::string_view str) -> std::string {
+    std::string lower_str(str);
+    std::transform(lower_str.begin(), lower_str.end(), lower_str.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower_str;
+}
+
+auto mime_type_map() -> const std::unordered_map<std::string, std::string>& {
+    static const std::unordered_map<std::string, std::string> map = {
+        {".txt", "text/plain"},
+        {".md", "text/markdown"},
+        {".json", "application/json"},
+        {".xml", "application/xml"},
+        {".html", "text/html"},
+        {".css", "text/css"},
+        {".js", "application/javascript"},
+        {".py", "text/x-python"},
+        {".cpp", "text/x-c++"},
+        {".hpp", "text/x-c++"},
+        {".h", "text/x-c++"},
+        {".c", "text/x-c"},
+        {".java", "text/x-java-source"},
+        {".rs", "text/rust"},
+        {".toml", "application/toml"},
+        {".yaml", "application/yaml"},
+        {".yml", "application/yaml"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"},
+        {".gif", "image/gif"},
+        {".webp", "image/webp"},
+        {".pdf", "application/pdf"},
+        {".zip", "application/zip"},
+    };
+    return map;
+}
+
+auto is_text_mime(std::string_view mime_type) -> bool {
+    return mime_type.rfind("text/", 0) == 0 || mime_type == "application/json" ||
+           mime_type == "application/javascript" || mime_type == "application/xml";
+}
+
+/// Map `file`, or the part of it `range` selects, if it exists and fits its size limit, otherwise `error` is the text
+/// sent back instead.
+auto map_file_resource(const detail::LocalFileResource& file, std::string_view& error,
+                       const detail::ByteRange* range = nullptr) -> detail::MappedFile {
+    std::error_code ec;
+    // A text range may have to finish the UTF-8 sequence it ends in, which is at most 3 more bytes.
+    const std::size_t lookahead = file.isText() ? 3 : 0;
+    auto mapped                 = range == nullptr
+                                      ? detail::MappedFile::open(file.path, ec, file.maxSize, file.mapped)
+                                      : detail::MappedFile::open(file.path, ec, *range, file.maxSize, lookahead,
+                                                                 file.mapped);
+    if (ec) {
+        if (ec == std::errc::no_such_file_or_directory) {
+            NEKO_LOG_WARN("mcp server", "Resource file not found: {}", file.path.string());
+            error = "Error: File not found.";
+        } else if (ec == std::errc::file_too_large) {
+            NEKO_LOG_WARN("mcp server", "Resource file exceeds size limit of {} bytes: {}", file.maxSize,
+                          file.path.string());
+            error = "Error: File is too large to read.";
+        } else {
+            NEKO_LOG_ERROR("mcp server", "Failed to map resource {}: {}", file.path.string(), ec.message());
+            error = "Error: Could not open file.";
+        }
+    }
+    return mapped;
+}
+
+/// Text of a text file or base64 of a binary one, as resources/read sends it.
+auto encode_payload(const detail::LocalFileResource& file, const detail::MappedFile& mapped)
+    -> std::shared_ptr<const std::string> {
+    if (file.isText()) {
+        return std::make_shared<const std::string>(mapped.view());
+    }
+    auto blob = std::make_shared<std::string>(detail::base64_encoded_size(mapped.size()), '\0');
+    detail::base64_encode(mapped.bytes(), blob->data());
+    return blob;
+}
+
+auto is_utf8_continuation(char c) noexcept -> bool { return (static_cast<unsigned char>(c) & 0xC0) == 0x80; }
+
+auto utf8_sequence_length(char c) noexcept -> std::size_t {
+    const auto byte = static_cast<unsigned char>(c);
+    if ((byte & 0xE0) == 0xC0) {
+        return 2;
+    }
+    if ((byte & 0xF0) == 0xE0) {
+        return 3;
+    }
+    if ((byte & 0xF8) == 0xF0) {
+        return 4;
+    }
+    return 1;
+}
+
+/// The bytes of a ranged read. A text range skips the tail of a UTF-8 sequence it starts in, the previous chunk ended
+/// with it, and finishes the one it ends in from the lookahead, so every chunk is valid text on its own.
+auto range_slice(const detail::LocalFileResource& file, const detail::MappedFile& mapped) -> std::string_view {
+    const auto text = mapped.view();
+    if (!file.isText()) {
+        return text;
+    }
+    std::size_t skip = 0;
+    if (mapped.offset() > 0) {
+        while (skip < text.size() && skip < 3 && is_utf8_continuation(text[skip])) {
+            ++skip;
+        }
+    }
+    std::size_t extend = 0;
+    for (std::size_t idx = text.size(); idx > skip && text.size() - idx < 4;) {
+        if (is_utf8_continuation(text[--idx])) {
+            continue;
+        }
+        const auto length    = utf8_sequence_length(text[idx]);
+        const auto present   = text.size() - idx;
+        const auto lookahead = mapped.lookahead();
+        while (present + extend < length && extend < lookahead.size() && is_utf8_continuation(lookahead[extend])) {
+            ++extend;
+        }
+        break;
+    }
+    return {text.data() + skip, text.size() - skip + extend};
+}
+
+auto append_range_meta(std::string& out, std::uintmax_t offset, std::uintmax_t length, std::uintmax_t total)
+    -> void {
+    out.append(R"("_meta":{"offset":)").append(std::to_string(offset));
+    out.append(R"(,"length":)").append(std::to_string(length));
+    out.append(R"(,"totalSize":)").append(std::to_string(total));
+    if (offset + length < total) {
+        out.append(R"(,"nextOffset":)").append(std::to_string(offset + length));
+    }
+    out.push_back('}');
+}
+
+auto load_payload(const detail::LocalFileResource& file, detail::FileContentCache& cache, std::string_view& error)
+    -> std::shared_ptr<const std::string> {
+    return cache.get(file.path, [&]() -> std::shared_ptr<const std::string> {
+        auto mapped = map_file_resource(file, error);
+        return error.empty() ? encode_payload(file, mapped) : nullptr;
+    });
+}
+} // namespace
+
+namespace detail {
+auto ByteRange::resolve(std::uintmax_t size, std::uintmax_t maxLength) const noexcept
+    -> std::pair<std::uintmax_t, std::uintmax_t> {
+    std::uintmax_t first = 0;
+    std::uintmax_t count = 0;
+    if (fromEnd) {
+        count = std::min(length.value_or(size), size);
+        first = size - count;
+    } else {
+        first = std::min(offset, size);
+        count = std::min(length.value_or(size - first), size - first);
+    }
+    return {first, std::min(count, maxLength)};
+}
+
+auto split_byte_range(std::string_view uri) noexcept -> std::pair<std::string_view, std::optional<ByteRange>> {
+    constexpr std::string_view marker = "#bytes=";
+    const auto pos                    = uri.rfind(marker);
+    if (pos == std::string_view::npos) {
+        return {uri, std::nullopt};
+    }
+    const auto spec = uri.substr(pos + marker.size());
+    const auto dash = spec.find('-');
+    if (dash == std::string_view::npos) {
+        return {uri, std::nullopt};
+    }
+    auto parse = [](std::string_view text, std::uintmax_t& value) {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc{} && ptr == text.data() + text.size();
+    };
+    ByteRange range;
+    std::uintmax_t last = 0;
+    if (dash == 0) {
+        if (!parse(spec.substr(1), last)) {
+            return {uri, std::nullopt};
+        }
+        range.fromEnd = true;
+        range.length  = last;
+    } else if (!parse(spec.substr(0, dash), range.offset)) {
+        return {uri, std::nullopt};
+    } else if (dash + 1 < spec.size()) {
+        if (!parse(spec.substr(dash + 1), last) || last < range.offset) {
+            return {uri, std::nullopt};
+        }
+        if (last - range.offset != UINTMAX_MAX) {
+            range.length = last - range.offset + 1;
+        }
+    }
+    return {uri.substr(0, pos), range};
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mBase(std::exchange(other.mBase, nullptr)), mMapSize(std::exchange(other.mMapSize, 0)),
+      mBuffer(std::move(other.mBuffer)), mData(std::exchange(other.mData, nullptr)),
+      mSize(std::exchange(other.mSize, 0)), mLookahead(std::exchange(other.mLookahead, 0)),
+      mOffset(std::exchange(other.mOffset, 0)), mFileSize(std::exchange(other.mFileSize, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        _unmap();
+        mBase      = std::exchange(other.mBase, nullptr);
+        mMapSize   = std::exchange(other.mMapSize, 0);
+        mBuffer    = std::move(other.mBuffer);
+        mData      = std::exchange(other.mData, nullptr);
+        mSize      = std::exchange(other.mSize, 0);
+        mLookahead = std::exchange(other.mLookahead, 0);
+        mOffset    = std::exchange(other.mOffset, 0);
+        mFileSize  = std::exchange(other.mFileSize, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { _unmap(); }
+
+auto MappedFile::open(const std::filesystem::path& path, std::error_code& ec, std::uintmax_t maxSize, bool map)
+    -> MappedFile {
+    return _open(path, ec, nullptr, maxSize, 0, map);
+}
+
+auto MappedFile::open(const std::filesystem::path& path, std::error_code& ec, const ByteRange& range,
+                      std::uintmax_t maxLength, std::size_t lookahead, bool map) -> MappedFile {
+    return _open(path, ec, &range, maxLength, lookahead, map);
+}
+
+auto MappedFile::_open(const std::filesystem::path& path, std::error_code& ec, const ByteRange* range,
+                       std::uintmax_t limit, std::size_t lookahead, [[maybe_unused]] bool map) -> MappedFile {
+    ec.clear();
+    MappedFile mapped;
+    // Where the view lies in the file, the mapping itself has to start at a multiple of `granularity`.
+    std::uintmax_t start = 0;
+    std::uintmax_t span  = 0;
+
+    auto place = [&](std::uintmax_t size, std::uintmax_t granularity) {
+        std::uintmax_t offset = 0;
+        std::uintmax_t length = size;
+        if (range == nullptr) {
+            if (size > limit) {
+                ec = std::make_error_code(std::errc::file_too_large);
+                return false;
+            }
+        } else {
+            std::tie(offset, length) = range->resolve(size, limit);
+        }
+        const auto extra = std::min<std::uintmax_t>(lookahead, size - offset - length);
+        start            = offset - offset % granularity;
+        span             = offset - start + length + extra;
+        if (span > SIZE_MAX) {
+            ec = std::make_error_code(std::errc::file_too_large);
+            return false;
+        }
+        mapped.mOffset    = offset;
+        mapped.mFileSize  = size;
+        mapped.mSize      = static_cast<std::size_t>(length);
+        mapped.mLookahead = static_cast<std::size_t>(extra);
+        return true;
+    };
+    auto attach = [&](const void* base) {
+        mapped.mBase    = base;
+        mapped.mMapSize = static_cast<std::size_t>(span);
+        mapped.mData    = static_cast<const char*>(base) + (mapped.mOffset - start);
+    };
+#if defined(_WIN32)
+    HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+        return mapped;
+    }
+    LARGE_INTEGER size{};
+    SYSTEM_INFO system{};
+    ::GetSystemInfo(&system);
+    if (!::GetFileSizeEx(file, &size)) {
+        ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+    } else if (place(static_cast<std::uintmax_t>(size.QuadPart), system.dwAllocationGranularity) && span > 0) {
+        HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+        } else {
+            // The view keeps the mapping object alive.
+            const void* base = ::MapViewOfFile(mapping, FILE_MAP_READ, static_cast<DWORD>(start >> 32),
+                                               static_cast<DWORD>(start & 0xFFFFFFFF), static_cast<SIZE_T>(span));
+            if (base == nullptr) {
+                ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+            } else {
+                attach(base);
+            }
+            ::CloseHandle(mapping);
+        }
+    }
+    ::CloseHandle(file);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ec = std::error_code(errno, std::generic_category());
+        return mapped;
+    }
+    const auto page = static_cast<std::uintmax_t>(::sysconf(_SC_PAGESIZE));
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ec = std::error_code(errno, std::generic_category());
+    } else if (!S_ISREG(st.st_mode)) {
+        ec = std::make_error_code(std::errc::invalid_argument);
+    } else if (place(static_cast<std::uintmax_t>(st.st_size), page) && span > 0 && map) {
+        void* base = ::mmap(nullptr, static_cast<std::size_t>(span), PROT_READ, MAP_PRIVATE, fd,
+                            static_cast<off_t>(start));
+        if (base == MAP_FAILED) {
+            ec = std::error_code(errno, std::generic_category());
+        } else {
+            ::madvise(base, static_cast<std::size_t>(span), MADV_SEQUENTIAL);
+            attach(base);
+        }
+    } else if (span > 0 && !ec) {
+        // Pages of a mapping past the end of a file truncated meanwhile raise SIGBUS, a copy only comes out shorter.
+        const auto size = static_cast<std::size_t>(span);
+        mapped.mBuffer  = std::make_unique_for_overwrite<char[]>(size);
+        std::size_t got = 0;
+        while (got < size) {
+            const auto ret = ::pread(fd, mapped.mBuffer.get() + got, size - got, static_cast<off_t>(start + got));
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ret < 0) {
+                ec = std::error_code(errno, std::generic_category());
+                break;
+            }
+            if (ret == 0) {
+                break;
+            }
+            got += static_cast<std::size_t>(ret);
+        }
+        if (got < size) {
+            // The file shrank since fstat(), the view ends where the file does now.
+            const auto end    = start + got;
+            mapped.mOffset    = std::min(mapped.mOffset, end);
+            mapped.mFileSize  = end;
+            const auto left   = static_cast<std::size_t>(end - mapped.mOffset);
+            mapped.mSize      = std::min(mapped.mSize, left);
+            mapped.mLookahead = std::min(mapped.mLookahead, left - mapped.mSize);
+        }
+        mapped.mData = mapped.mBuffer.get() + (mapped.mOffset - start);
+    }
+    ::close(fd);
+#endif
+    if (ec) {
+        return MappedFile{};
+    }
+    return mapped;
+}
+
+auto MappedFile::_unmap() noexcept -> void {
+    if (mBase != nullptr) {
+#if defined(_WIN32)
+        ::UnmapViewOfFile(mBase);
+#else
+        ::munmap(const_cast<void*>(mBase), mMapSize);
+#endif
+    }
+    mBase      = nullptr;
+    mMapSize   = 0;
+    mBuffer.reset();
+    mData      = nullptr;
+    mSize      = 0;
+    mLookahead = 0;
+    mOffset    = 0;
+    mFileSize  = 0;
+}
+
+auto LocalFileResource::isText() const noexcept -> bool { return is_text_mime(mimeType); }
+
+auto file_mime_type(const std::filesystem::path& path) -> std::string {
+    const auto& mime_types = mime_type_map();
+    const auto it          = mime_types.find(to_lower(path.extension().string()));
+    return it != mime_types.end() ? it->second : "application/octet-stream";
+}
+
+auto append_file_resource_result(std::string& out, const LocalFileResource& file, std::string_view uri,
+                                 FileContentCache* cache) -> void {
+    std::string_view error;
+    MappedFile mapped;
+    std::shared_ptr<const std::string> payload;
+    if (cache != nullptr && cache->enabled()) {
+        payload = load_payload(file, *cache, error);
+    } else {
+        mapped = map_file_resource(file, error);
+    }
+    out.append(R"({"contents":[{"uri":)");
+    json_append_string(out, uri);
+    if (!error.empty()) {
+        out.append(R"(,"text":)");
+        json_append_string(out, error);
+        out.append(R"(,"mimeType":"text/plain"}]})");
+        return;
+    }
+    if (file.isText()) {
+        const auto text = payload ? std::string_view(*payload) : mapped.view();
+        out.reserve(out.size() + text.size() + file.mimeType.size() + 32);
+        out.append(R"(,"text":)");
+        json_append_string(out, text);
+    } else if (payload) {
+        out.reserve(out.size() + payload->size() + file.mimeType.size() + 32);
+        out.append(R"(,"blob":")").append(*payload).push_back('"');
+    } else {
+        out.reserve(out.size() + base64_encoded_size(mapped.size()) + file.mimeType.size() + 32);
+        out.append(R"(,"blob":")");
+        base64_append(out, mapped.bytes());
+        out.push_back('"');
+    }
+    out.append(R"(,"mimeType":)");
+    json_append_string(out, file.mimeType);
+    out.append("}]}");
+}
+
+auto read_file_resource(const LocalFileResource& file, const std::string& uri, FileContentCache* cache)
+    -> ResourceContents {
+    std::string_view error;
+    if (cache != nullptr && cache->enabled()) {
+        auto payload = load_payload(file, *cache, error);
+        if (!error.empty()) {
+            return TextResourceContents{.uri = uri, .text = std::string(error), .mimeType = "text/plain"};
+        }
+        if (file.isText()) {
+            return TextResourceContents{.uri = uri, .text = *payload, .mimeType = file.mimeType};
+        }
+        return BlobResourceContents{.uri = uri, .blob = *payload, .mimeType = file.mimeType};
+    }
+    auto mapped = map_file_resource(file, error);
+    if (!error.empty()) {
+        return TextResourceContents{.uri = uri, .text = std::string(error), .mimeType = "text/plain"};
+    }
+    if (file.isText()) {
+        return TextResourceContents{.uri = uri, .text = std::string(mapped.view()), .mimeType = file.mimeType};
+    }
+    std::string blob(base64_encoded_size(mapped.size()), '\0');
+    base64_encode(mapped.bytes(), blob.data());
+    return BlobResourceContents{.uri = uri, .blob = std::move(blob), .mimeType = file.mimeType};
+}
+
+auto append_file_range_result(std::string& out, const LocalFileResource& file, std::string_view uri,
+                              const ByteRange& range) -> void {
+    std::string_view error;
+    auto mapped = map_file_resource(file, error, &range);
+    out.append(R"({"contents":[{"uri":)");
+    json_append_string(out, uri);
+    if (!error.empty()) {
+        out.append(R"(,"text":)");
+        json_append_string(out, error);
+        out.append(R"(,"mimeType":"text/plain"}]})");
+        return;
+    }
+    const auto slice  = range_slice(file, mapped);
+    const auto offset = mapped.offset() + static_cast<std::uintmax_t>(slice.data() - mapped.view().data());
+    if (file.isText()) {
+        out.reserve(out.size() + slice.size() + file.mimeType.size() + 128);
+        out.append(R"(,"text":)");
+        json_append_string(out, slice);
+    } else {
+        out.reserve(out.size() + base64_encoded_size(slice.size()) + file.mimeType.size() + 128);
+        out.append(R"(,"blob":")");
+        base64_append(out, std::as_bytes(std::span(slice)));
+        out.push_back('"');
+    }
+    out.append(R"(,"mimeType":)");
+    json_append_string(out, file.mimeType);
+    out.append("}],");
+    append_range_meta(out, offset, slice.size(), mapped.fileSize());
+    out.push_back('}');
+}
+
+auto read_file_range(const LocalFileResource& file, const std::string& uri, const ByteRange& range)
+    -> ReadResourceResult {
+    ReadResourceResult result;
+    std::string_view error;
+    auto mapped = map_file_resource(file, error, &range);
+    if (!error.empty()) {
+        result.contents.push_back(
+            TextResourceContents{.uri = uri, .text = std::string(error), .mimeType = "text/plain"});
+        return result;
+    }
+    const auto slice  = range_slice(file, mapped);
+    const auto offset = mapped.offset() + static_cast<std::uintmax_t>(slice.data() - mapped.view().data());
+    const auto end    = offset + slice.size();
+    if (file.isText()) {
+        result.contents.push_back(
+            TextResourceContents{.uri = uri, .text = std::string(slice), .mimeType = file.mimeType});
+    } else {
+        std::string blob(base64_encoded_size(slice.size()), '\0');
+        base64_encode(std::as_bytes(std::span(slice)), blob.data());
+        result.contents.push_back(
+            BlobResourceContents{.uri = uri, .blob = std::move(blob), .mimeType = file.mimeType});
+    }
+    result._meta = ResourceRangeMeta{
+        .offset     = static_cast<int64_t>(offset),
+        .length     = static_cast<int64_t>(slice.size()),
+        .totalSize  = static_cast<int64_t>(mapped.fileSize()),
+        .nextOffset = end < mapped.fileSize() ? std::optional<int64_t>(end) : std::nullopt,
+    };
+    return result;
+}
+
+auto createResourceContentsFromFile(const std::filesystem::path& path, const std::string& uri, std::uintmax_t maxSize)
+    -> ResourceContents {
+    return read_file_resource(LocalFileResource{.path = path, .mimeType = file_mime_type(path), .maxSize = maxSize},
+                              uri);
+}
+} // namespace detail
+
+CCMCP_EN
@@ -0,0 +1,184 @@
+#include "ccmcp/server/logging.hpp"
+
+#include "ccmcp/model/raw_message.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+
+CCMCP_BN
+
+namespace {
+constexpr std::array<std::string_view, 8> kLevelNames = {"debug", "info",     "notice", "warning",
+                                                         "error", "critical", "alert",  "emergency"};
+} // namespace
+
+auto log_level_from_string(std::string_view name) noexcept -> std::optional<LogLevel> {
+    for (std::size_t idx = 0; idx < kLevelNames.size(); ++idx) {
+        if (kLevelNames[idx] == name) {
+            return static_cast<LogLevel>(idx);
+        }
+    }
+    return std::nullopt;
+}
+
+auto log_level_name(LogLevel level) noexcept -> std::string_view {
+    const auto idx = static_cast<std::size_t>(level);
+    return idx < kLevelNames.size() ? kLevelNames[idx] : std::string_view{};
+}
+
+namespace detail {
+LogRing::LogRing(std::size_t capacity)
+    : mCells(std::make_unique<Cell[]>(std::bit_ceil(std::max<std::size_t>(capacity, 2)))),
+      mMask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1) {
+    for (std::size_t idx = 0; idx <= mMask; ++idx) {
+        mCells[idx].sequence.store(idx, std::memory_order_relaxed);
+    }
+}
+
+auto LogRing::tryPush(LogRecord& record) noexcept -> bool {
+    auto pos = mEnqueue.load(std::memory_order_relaxed);
+    while (true) {
+        auto& cell      = mCells[pos & mMask];
+        const auto seq  = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (mEnqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.record = std::move(record);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = mEnqueue.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+auto LogRing::tryPop(LogRecord& record) noexcept -> bool {
+    auto pos = mDequeue.load(std::memory_order_relaxed);
+    while (true) {
+        auto& cell      = mCells[pos & mMask];
+        const auto seq  = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+        if (diff == 0) {
+            if (mDequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                record = std::move(cell.record);
+                cell.sequence.store(pos + mMask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = mDequeue.load(std::memory_order_relaxed);
+        }
+    }
+}
+} // namespace detail
+
+LogPipeline::LogPipeline(ILIAS_NAMESPACE::IoContext& context, const LogOptions& options)
+    : mContext(context), mRing(options.capacity), mMaxPerSecond(options.maxPerSecond),
+      mSampleEvery(options.sampleEvery) {}
+
+auto LogPipeline::setLimits(uint32_t maxPerSecond, uint32_t sampleEvery) noexcept -> void {
+    mMaxPerSecond.store(maxPerSecond, std::memory_order_relaxed);
+    mSampleEvery.store(sampleEvery, std::memory_order_relaxed);
+}
+
+auto LogPipeline::setLevel(const std::shared_ptr<detail::McpSession>& session, LogLevel level) -> void {
+    auto it = std::find_if(mSubscribers.begin(), mSubscribers.end(),
+                           [&](const Subscriber& subscriber) { return subscriber.session.lock() == session; });
+    if (it != mSubscribers.end()) {
+        it->level = level;
+    } else {
+        mSubscribers.push_back(Subscriber{.session = session, .level = level});
+    }
+    _update_threshold();
+}
+
+auto LogPipeline::_admit(LogLevel level) noexcept -> bool {
+    if (level < LogLevel::Warning) {
+        if (const auto every = mSampleEvery.load(std::memory_order_relaxed);
+            every > 1 && mSampleCounter.fetch_add(1, std::memory_order_relaxed) % every != 0) {
+            return false;
+        }
+    }
+    const auto limit = mMaxPerSecond.load(std::memory_order_relaxed);
+    if (limit == 0) {
+        return true;
+    }
+    const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count();
+    if (auto window = mWindow.load(std::memory_order_relaxed);
+        window != now && mWindow.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+        mWindowCount.store(0, std::memory_order_relaxed);
+    }
+    if (mWindowCount.fetch_add(1, std::memory_order_relaxed) >= limit) {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+auto LogPipeline::_push(LogLevel level, std::string_view logger, std::string text) -> void {
+    detail::LogRecord record{.level = level, .logger = std::string(logger), .text = std::move(text)};
+    if (!mRing.tryPush(record)) {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (!mDrainPosted.exchange(true, std::memory_order_acq_rel)) {
+        mPosts.post<&LogPipeline::_drain>(mContext);
+    }
+}
+
+auto LogPipeline::_update_threshold() -> void {
+    auto threshold = LogLevel::Off;
+    for (const auto& subscriber : mSubscribers) {
+        threshold = std::min(threshold, subscriber.level);
+    }
+    mThreshold.store(threshold, std::memory_order_relaxed);
+}
+
+auto LogPipeline::_drain(void* self) -> void {
+    auto& pipeline = *static_cast<LogPipeline*>(self);
+    // Cleared before popping, a record pushed from now on posts another drain instead of being left behind.
+    pipeline.mDrainPosted.store(false, std::memory_order_release);
+    const auto closed = std::erase_if(pipeline.mSubscribers, [](const Subscriber& subscriber) {
+        auto session = subscriber.session.lock();
+        return !session || session->isClosed();
+    });
+    if (closed != 0) {
+        pipeline._update_threshold();
+    }
+    detail::LogRecord record;
+    while (pipeline.mRing.tryPop(record)) {
+        std::shared_ptr<const std::string> message;
+        for (const auto& subscriber : pipeline.mSubscribers) {
+            if (record.level < subscriber.level) {
+                continue;
+            }
+            auto session = subscriber.session.lock();
+            if (!session) {
+                continue;
+            }
+            if (!message) {
+                std::string text;
+                text.reserve(record.text.size() + record.logger.size() + 96);
+                text.append(R"({"jsonrpc":"2.0","method":"notifications/message","params":{"level":")")
+                    .append(log_level_name(record.level))
+                    .append(R"(","logger":)");
+                detail::json_append_string(text, record.logger);
+                text.append(R"(,"data":)");
+                detail::json_append_string(text, record.text);
+                text.append("}}");
+                message = std::make_shared<const std::string>(std::move(text));
+            }
+            session->post(message);
+        }
+    }
+}
+
+CCMCP_EN
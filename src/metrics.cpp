@@ -0,0 +1,101 @@
+#include "ccmcp/server/metrics.hpp"
+
+#include "ccmcp/server/system_info.hpp"
+
+#include <algorithm>
+
+CCMCP_BN
+
+namespace {
+auto append_label(std::string& out, std::string_view metric, std::string_view tool) -> void {
+    out.append(metric).append("{tool=\"");
+    for (char c : tool) {
+        if (c == '\\' || c == '"') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (c == '\n') {
+            out.append("\\n");
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+auto append_sample(std::string& out, uint64_t value) -> void {
+    out.push_back(' ');
+    out.append(std::to_string(value)).push_back('\n');
+}
+} // namespace
+
+auto LatencyHistogram::percentile(double quantile) const noexcept -> uint64_t {
+    const auto total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const auto rank = static_cast<uint64_t>(quantile * static_cast<double>(total - 1)) + 1;
+    uint64_t seen   = 0;
+    for (std::size_t idx = 0; idx < kBucketCount; ++idx) {
+        seen += bucket(idx);
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(idx), max());
+        }
+    }
+    return max();
+}
+
+auto MetricsRegistry::tool(std::string_view name) -> ToolMetrics& {
+    std::lock_guard lock(mMutex);
+    if (auto it = mTools.find(name); it != mTools.end()) {
+        return *it->second;
+    }
+    return *mTools.emplace(std::string(name), std::make_unique<ToolMetrics>()).first->second;
+}
+
+auto MetricsRegistry::sampleRss() -> void { mRss.store(getCurrentRSS(), std::memory_order_relaxed); }
+
+auto MetricsRegistry::exposition() const -> std::string {
+    std::string out;
+    std::lock_guard lock(mMutex);
+    out.append("# TYPE mcp_tool_calls_total counter\n");
+    for (const auto& [name, metrics] : mTools) {
+        append_label(out, "mcp_tool_calls_total", name);
+        out.push_back('}');
+        append_sample(out, metrics->calls.load(std::memory_order_relaxed));
+    }
+    out.append("# TYPE mcp_tool_errors_total counter\n");
+    for (const auto& [name, metrics] : mTools) {
+        append_label(out, "mcp_tool_errors_total", name);
+        out.push_back('}');
+        append_sample(out, metrics->errors.load(std::memory_order_relaxed));
+    }
+    out.append("# TYPE mcp_tool_latency_microseconds histogram\n");
+    for (const auto& [name, metrics] : mTools) {
+        const auto& latency = metrics->latency;
+        uint64_t cumulative = 0;
+        // Empty buckets are skipped, cumulative counts stay correct without them. The total is taken from the
+        // buckets read here so the series stays consistent while calls are being recorded.
+        for (std::size_t idx = 0; idx < LatencyHistogram::kBucketCount; ++idx) {
+            if (const auto count = latency.bucket(idx); count != 0) {
+                cumulative += count;
+                append_label(out, "mcp_tool_latency_microseconds_bucket", name);
+                out.append(",le=\"").append(std::to_string(LatencyHistogram::bucketUpperBound(idx))).append("\"}");
+                append_sample(out, cumulative);
+            }
+        }
+        append_label(out, "mcp_tool_latency_microseconds_bucket", name);
+        out.append(",le=\"+Inf\"}");
+        append_sample(out, cumulative);
+        append_label(out, "mcp_tool_latency_microseconds_sum", name);
+        out.push_back('}');
+        append_sample(out, latency.sum());
+        append_label(out, "mcp_tool_latency_microseconds_count", name);
+        out.push_back('}');
+        append_sample(out, cumulative);
+    }
+    out.append("# TYPE mcp_process_resident_memory_bytes gauge\nmcp_process_resident_memory_bytes");
+    append_sample(out, rss());
+    return out;
+}
+
+CCMCP_EN
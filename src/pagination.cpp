@@ -0,0 +1,57 @@
+#include "ccmcp/server/pagination.hpp"
+
+CCMCP_BN
+
+namespace {
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+auto hex_value(char c) noexcept -> int {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+} // namespace
+
+namespace detail {
+auto encode_cursor(std::string_view scope, std::string_view lastKey) -> std::string {
+    std::string cursor;
+    cursor.reserve((scope.size() + lastKey.size() + 1) * 2);
+    auto append = [&cursor](std::string_view text) {
+        for (unsigned char c : text) {
+            cursor.push_back(kHexDigits[c >> 4]);
+            cursor.push_back(kHexDigits[c & 0xF]);
+        }
+    };
+    append(scope);
+    append(":");
+    append(lastKey);
+    return cursor;
+}
+
+auto decode_cursor(std::string_view scope, std::string_view cursor) -> std::optional<std::string> {
+    if (cursor.size() % 2 != 0) {
+        return std::nullopt;
+    }
+    std::string decoded;
+    decoded.reserve(cursor.size() / 2);
+    for (std::size_t idx = 0; idx < cursor.size(); idx += 2) {
+        const int high = hex_value(cursor[idx]);
+        const int low  = hex_value(cursor[idx + 1]);
+        if (high < 0 || low < 0) {
+            return std::nullopt;
+        }
+        decoded.push_back(static_cast<char>((high << 4) | low));
+    }
+    if (decoded.size() <= scope.size() || decoded.compare(0, scope.size(), scope) != 0 ||
+        decoded[scope.size()] != ':') {
+        return std::nullopt;
+    }
+    return decoded.substr(scope.size() + 1);
+}
+} // namespace detail
+
+CCMCP_EN
@@ -0,0 +1,81 @@
+#include "ccmcp/server/progress.hpp"
+
+#include <ilias/task.hpp>
+
+#include <charconv>
+#include <utility>
+
+CCMCP_BN
+
+namespace {
+auto append_number(std::string& out, float value) -> void {
+    char buffer[32];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, ec == std::errc{} ? end : buffer);
+}
+} // namespace
+
+namespace detail {
+auto ProgressReporter::report(float progress, std::optional<float> total) -> void {
+    const auto now = Clock::now();
+    if (mLast && now - *mLast < mInterval) {
+        mPending = Progress{.progress = progress, .total = total};
+        if (!mArmed) {
+            mArmed = true;
+            mTimer = ILIAS_NAMESPACE::spawn(_trailing(*mLast + mInterval - now));
+        }
+        return;
+    }
+    mLast    = now;
+    mPending = std::nullopt;
+    _send(Progress{.progress = progress, .total = total});
+}
+
+auto ProgressReporter::flush() -> void {
+    _disarm();
+    if (mPending) {
+        _send(*mPending);
+        mPending = std::nullopt;
+    }
+}
+
+auto ProgressReporter::_trailing(Clock::duration delay) -> ILIAS_NAMESPACE::Task<void> {
+    if (auto ret = co_await ILIAS_NAMESPACE::sleep(std::chrono::ceil<std::chrono::milliseconds>(delay)); !ret) {
+        // Stopped by flush() or by the destructor, the reporter may be gone.
+        co_return;
+    }
+    mArmed = false;
+    if (mPending) {
+        mLast = Clock::now();
+        _send(*mPending);
+        mPending = std::nullopt;
+    }
+}
+
+auto ProgressReporter::_disarm() -> void {
+    if (std::exchange(mArmed, false)) {
+        mTimer.stop();
+    }
+}
+
+auto ProgressReporter::_send(const Progress& progress) -> void {
+    auto session = mSession.lock();
+    if (!session) {
+        return;
+    }
+    std::string message;
+    message.reserve(mToken.size() + 112);
+    message.append(R"({"jsonrpc":"2.0","method":"notifications/progress","params":{"progressToken":)").append(mToken);
+    message.append(R"(,"progress":)");
+    append_number(message, progress.progress);
+    if (progress.total) {
+        message.append(R"(,"total":)");
+        append_number(message, *progress.total);
+    }
+    message.append("}}");
+    session->post(std::move(message));
+    ++mSent;
+}
+} // namespace detail
+
+CCMCP_EN
@@ -0,0 +1,351 @@
+#include "ccmcp/model/raw_message.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+CCMCP_BN
+
+namespace {
+auto is_ws(char c) noexcept -> bool { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+auto skip_string(std::string_view json, std::size_t pos) noexcept -> std::size_t {
+    // pos points at the opening quote
+    for (++pos; pos < json.size(); ++pos) {
+        if (json[pos] == '\\') {
+            ++pos;
+        } else if (json[pos] == '"') {
+            return pos + 1;
+        }
+    }
+    return std::string_view::npos;
+}
+} // namespace
+
+namespace detail {
+auto json_skip_ws(std::string_view json, std::size_t pos) noexcept -> std::size_t {
+    while (pos < json.size() && is_ws(json[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+auto json_skip_value(std::string_view json, std::size_t pos) noexcept -> std::size_t {
+    pos = json_skip_ws(json, pos);
+    if (pos >= json.size()) {
+        return std::string_view::npos;
+    }
+    switch (json[pos]) {
+    case '"':
+        return skip_string(json, pos);
+    case '{':
+    case '[': {
+        std::size_t depth = 0;
+        for (; pos < json.size(); ++pos) {
+            switch (json[pos]) {
+            case '"':
+                pos = skip_string(json, pos);
+                if (pos == std::string_view::npos) {
+                    return pos;
+                }
+                --pos;
+                break;
+            case '{':
+            case '[':
+                ++depth;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0) {
+                    return pos + 1;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        return std::string_view::npos;
+    }
+    default: {
+        const auto begin = pos;
+        while (pos < json.size() && !is_ws(json[pos]) && json[pos] != ',' && json[pos] != '}' && json[pos] != ']') {
+            ++pos;
+        }
+        return pos == begin ? std::string_view::npos : pos;
+    }
+    }
+}
+
+auto json_members(std::string_view object) -> std::optional<std::vector<std::pair<std::string_view, std::string_view>>> {
+    std::vector<std::pair<std::string_view, std::string_view>> members;
+    auto pos = json_skip_ws(object, 0);
+    if (pos >= object.size() || object[pos] != '{') {
+        return std::nullopt;
+    }
+    pos = json_skip_ws(object, pos + 1);
+    if (pos < object.size() && object[pos] == '}') {
+        return members;
+    }
+    while (pos < object.size()) {
+        if (object[pos] != '"') {
+            return std::nullopt;
+        }
+        const auto keyEnd = skip_string(object, pos);
+        if (keyEnd == std::string_view::npos) {
+            return std::nullopt;
+        }
+        const auto key = object.substr(pos + 1, keyEnd - pos - 2);
+        pos            = json_skip_ws(object, keyEnd);
+        if (pos >= object.size() || object[pos] != ':') {
+            return std::nullopt;
+        }
+        const auto valueBegin = json_skip_ws(object, pos + 1);
+        const auto valueEnd   = json_skip_value(object, valueBegin);
+        if (valueEnd == std::string_view::npos) {
+            return std::nullopt;
+        }
+        members.emplace_back(key, object.substr(valueBegin, valueEnd - valueBegin));
+        pos = json_skip_ws(object, valueEnd);
+        if (pos < object.size() && object[pos] == ',') {
+            pos = json_skip_ws(object, pos + 1);
+        } else if (pos < object.size() && object[pos] == '}') {
+            return members;
+        } else {
+            return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+auto json_member(std::string_view object, std::string_view key) noexcept -> std::optional<std::string_view> {
+    auto pos = json_skip_ws(object, 0);
+    if (pos >= object.size() || object[pos] != '{') {
+        return std::nullopt;
+    }
+    pos = json_skip_ws(object, pos + 1);
+    while (pos < object.size() && object[pos] == '"') {
+        const auto keyEnd = skip_string(object, pos);
+        if (keyEnd == std::string_view::npos) {
+            return std::nullopt;
+        }
+        const bool match = object.substr(pos + 1, keyEnd - pos - 2) == key;
+        pos              = json_skip_ws(object, keyEnd);
+        if (pos >= object.size() || object[pos] != ':') {
+            return std::nullopt;
+        }
+        const auto valueBegin = json_skip_ws(object, pos + 1);
+        const auto valueEnd   = json_skip_value(object, valueBegin);
+        if (valueEnd == std::string_view::npos) {
+            return std::nullopt;
+        }
+        if (match) {
+            return object.substr(valueBegin, valueEnd - valueBegin);
+        }
+        pos = json_skip_ws(object, valueEnd);
+        if (pos >= object.size() || object[pos] != ',') {
+            return std::nullopt;
+        }
+        pos = json_skip_ws(object, pos + 1);
+    }
+    return std::nullopt;
+}
+
+auto json_elements(std::string_view array) -> std::optional<std::vector<std::string_view>> {
+    std::vector<std::string_view> elements;
+    auto pos = json_skip_ws(array, 0);
+    if (pos >= array.size() || array[pos] != '[') {
+        return std::nullopt;
+    }
+    pos = json_skip_ws(array, pos + 1);
+    if (pos < array.size() && array[pos] == ']') {
+        return elements;
+    }
+    while (pos < array.size()) {
+        const auto end = json_skip_value(array, pos);
+        if (end == std::string_view::npos) {
+            return std::nullopt;
+        }
+        elements.push_back(array.substr(pos, end - pos));
+        pos = json_skip_ws(array, end);
+        if (pos < array.size() && array[pos] == ',') {
+            pos = json_skip_ws(array, pos + 1);
+        } else if (pos < array.size() && array[pos] == ']') {
+            return elements;
+        } else {
+            return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+auto json_plain_string(std::string_view raw) noexcept -> std::optional<std::string_view> {
+    if (raw.size() < 2 || raw.front() != '"' || raw.back() != '"') {
+        return std::nullopt;
+    }
+    auto content = raw.substr(1, raw.size() - 2);
+    if (content.find('\\') != std::string_view::npos) {
+        return std::nullopt;
+    }
+    return content;
+}
+
+auto json_append_string(std::string& out, std::string_view text) -> void {
+    out.reserve(out.size() + text.size() + 2);
+    out.push_back('"');
+    // Copy runs of characters that need no escaping in one go, tool output is mostly plain text.
+    std::size_t run = 0;
+    for (std::size_t idx = 0; idx < text.size(); ++idx) {
+        const char c = text[idx];
+        if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20) {
+            continue;
+        }
+        out.append(text.data() + run, idx - run);
+        run = idx + 1;
+        switch (c) {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        case '\n':
+            out.append("\\n");
+            break;
+        case '\r':
+            out.append("\\r");
+            break;
+        case '\t':
+            out.append("\\t");
+            break;
+        default: {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out.append(escaped);
+        }
+        }
+    }
+    out.append(text.data() + run, text.size() - run);
+    out.push_back('"');
+}
+
+auto json_append_canonical(std::string& out, std::string_view value) -> bool {
+    const auto begin = json_skip_ws(value, 0);
+    if (begin >= value.size()) {
+        return false;
+    }
+    switch (value[begin]) {
+    case '{': {
+        auto members = json_members(value);
+        if (!members) {
+            return false;
+        }
+        std::sort(members->begin(), members->end(),
+                  [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+        out.push_back('{');
+        for (const auto& [key, member] : *members) {
+            if (out.back() != '{') {
+                out.push_back(',');
+            }
+            out.push_back('"');
+            out.append(key).append("\":");
+            if (!json_append_canonical(out, member)) {
+                return false;
+            }
+        }
+        out.push_back('}');
+        return true;
+    }
+    case '[': {
+        auto elements = json_elements(value);
+        if (!elements) {
+            return false;
+        }
+        out.push_back('[');
+        for (std::size_t idx = 0; idx < elements->size(); ++idx) {
+            if (idx != 0) {
+                out.push_back(',');
+            }
+            if (!json_append_canonical(out, (*elements)[idx])) {
+                return false;
+            }
+        }
+        out.push_back(']');
+        return true;
+    }
+    default: {
+        const auto end = json_skip_value(value, begin);
+        if (end == std::string_view::npos) {
+            return false;
+        }
+        out.append(value.substr(begin, end - begin));
+        return true;
+    }
+    }
+}
+
+auto make_raw_result(std::string_view id, std::string_view result) -> std::string {
+    std::string message;
+    message.reserve(result.size() + id.size() + 36);
+    message.append(R"({"jsonrpc":"2.0","id":)").append(id).append(R"(,"result":)").append(result).push_back('}');
+    return message;
+}
+
+auto make_raw_error(std::string_view id, int code, std::string_view message) -> std::string {
+    std::string out;
+    out.append(R"({"jsonrpc":"2.0","id":)").append(id.empty() ? "null" : id);
+    out.append(R"(,"error":{"code":)").append(std::to_string(code)).append(R"(,"message":)");
+    json_append_string(out, message);
+    out.append("}}");
+    return out;
+}
+} // namespace detail
+
+auto RawMessage::parse(std::string_view json) noexcept -> std::optional<RawMessage> {
+    auto pos = detail::json_skip_ws(json, 0);
+    if (pos >= json.size() || json[pos] != '{') {
+        return std::nullopt;
+    }
+    RawMessage message;
+    pos = detail::json_skip_ws(json, pos + 1);
+    while (pos < json.size() && json[pos] == '"') {
+        const auto keyEnd = skip_string(json, pos);
+        if (keyEnd == std::string_view::npos) {
+            return std::nullopt;
+        }
+        const auto key = json.substr(pos + 1, keyEnd - pos - 2);
+        pos            = detail::json_skip_ws(json, keyEnd);
+        if (pos >= json.size() || json[pos] != ':') {
+            return std::nullopt;
+        }
+        const auto valueBegin = detail::json_skip_ws(json, pos + 1);
+        const auto valueEnd   = detail::json_skip_value(json, valueBegin);
+        if (valueEnd == std::string_view::npos) {
+            return std::nullopt;
+        }
+        const auto value = json.substr(valueBegin, valueEnd - valueBegin);
+        if (key == "id") {
+            message.id = value == "null" ? std::string_view{} : value;
+        } else if (key == "method") {
+            message.method = detail::json_plain_string(value).value_or(std::string_view{});
+        } else if (key == "params") {
+            message.params = value;
+        }
+        pos = detail::json_skip_ws(json, valueEnd);
+        if (pos < json.size() && json[pos] == ',') {
+            pos = detail::json_skip_ws(json, pos + 1);
+            // A member list ending with a comma is malformed.
+            if (pos >= json.size() || json[pos] != '"') {
+                return std::nullopt;
+            }
+        } else if (pos < json.size() && json[pos] == '}') {
+            return message;
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (pos < json.size() && json[pos] == '}') {
+        return message;
+    }
+    return std::nullopt;
+}
+
+CCMCP_EN
@@ -0,0 +1,89 @@
+#include "ccmcp/server/result_cache.hpp"
+
+#include "ccmcp/model/raw_message.hpp"
+
+CCMCP_BN
+
+namespace detail {
+auto ToolResultCache::makeKey(std::string_view tool, std::string_view arguments) -> std::string {
+    std::string key;
+    key.reserve(tool.size() + arguments.size() + 1);
+    key.append(tool).push_back('\0');
+    if (arguments.empty() || arguments == "null") {
+        arguments = "{}";
+    }
+    if (!json_append_canonical(key, arguments)) {
+        return {};
+    }
+    return key;
+}
+
+auto ToolResultCache::setCapacity(std::size_t bytes) -> void {
+    mCapacity = bytes;
+    _evict();
+}
+
+auto ToolResultCache::find(const std::string& key) -> std::shared_ptr<const std::string> {
+    auto it = mIndex.find(key);
+    if (it == mIndex.end()) {
+        ++mMisses;
+        return nullptr;
+    }
+    if (it->second->expiry <= Clock::now()) {
+        _erase(it->second);
+        ++mMisses;
+        return nullptr;
+    }
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    ++mHits;
+    return mEntries.front().result;
+}
+
+auto ToolResultCache::insert(std::string key, std::shared_ptr<const std::string> result, std::chrono::milliseconds ttl)
+    -> void {
+    if (!enabled() || key.empty() || !result || ttl <= std::chrono::milliseconds::zero()) {
+        return;
+    }
+    if (auto it = mIndex.find(key); it != mIndex.end()) {
+        _erase(it->second);
+    }
+    auto tool = key.substr(0, key.find('\0'));
+    mEntries.push_front(Entry{
+        .key = std::move(key), .tool = std::move(tool), .result = std::move(result), .expiry = Clock::now() + ttl});
+    mBytes += mEntries.front().cost();
+    mIndex.emplace(mEntries.front().key, mEntries.begin());
+    _evict();
+}
+
+auto ToolResultCache::invalidate(std::string_view tool) -> std::size_t {
+    std::size_t count = 0;
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        auto current = it++;
+        if (current->tool == tool) {
+            _erase(current);
+            ++count;
+        }
+    }
+    return count;
+}
+
+auto ToolResultCache::clear() -> void {
+    mIndex.clear();
+    mEntries.clear();
+    mBytes = 0;
+}
+
+auto ToolResultCache::_erase(List::iterator it) -> void {
+    mBytes -= it->cost();
+    mIndex.erase(it->key);
+    mEntries.erase(it);
+}
+
+auto ToolResultCache::_evict() -> void {
+    while (mBytes > mCapacity && !mEntries.empty()) {
+        _erase(std::prev(mEntries.end()));
+    }
+}
+} // namespace detail
+
+CCMCP_EN
@@ -1,113 +1,55 @@
 #include "ccmcp/server/server.hpp"
 
+#include "ccmcp/server/pagination.hpp"
 #include "ccmcp/server/system_info.hpp"
 
-#include <nekoproto/serialization/types/binary_data.hpp>
+#include <ilias/task.hpp>
+#include <nekoproto/jsonrpc/jsonrpc_error.hpp>
 
 #include <algorithm>
-#include <cctype>
+#include <charconv>
 #include <chrono>
 #include <filesystem>
-#include <fstream>
-#include <iterator>
-#include <unordered_map>
 
 CCMCP_BN
 
 namespace {
-auto to_lower(std::string_view str) -> std::string {
-    std::string lower_str(str);
-    std::transform(lower_str.begin(), lower_str.end(), lower_str.begin(),
-                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    return lower_str;
-}
-
-auto mime_type_map() -> const std::unordered_map<std::string, std::string>& {
-    static const std::unordered_map<std::string, std::string> map = {
-        {".txt", "text/plain"},
-        {".md", "text/markdown"},
-        {".json", "application/json"},
-        {".xml", "application/xml"},
-        {".html", "text/html"},
-        {".css", "text/css"},
-        {".js", "application/javascript"},
-        {".py", "text/x-python"},
-        {".cpp", "text/x-c++"},
-        {".hpp", "text/x-c++"},
-        {".h", "text/x-c++"},
-        {".c", "text/x-c"},
-        {".java", "text/x-java-source"},
-        {".rs", "text/rust"},
-        {".toml", "application/toml"},
-        {".yaml", "application/yaml"},
-        {".yml", "application/yaml"},
-        {".png", "image/png"},
-        {".jpg", "image/jpeg"},
-        {".jpeg", "image/jpeg"},
-        {".gif", "image/gif"},
-        {".webp", "image/webp"},
-        {".pdf", "application/pdf"},
-        {".zip", "application/zip"},
-    };
-    return map;
+auto tool_call_info(std::chrono::steady_clock::time_point start, std::size_t rss, std::optional<std::string> error)
+    -> ToolCallInfo {
+    ToolCallInfo info;
+    info.error = std::move(error);
+    info.executionTime =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    info.resourceUsage.memory = std::to_string(rss / 1024) + "KB";
+    return info;
 }
 
-auto is_text_mime(std::string_view mime_type) -> bool {
-    return mime_type.rfind("text/", 0) == 0 || mime_type == "application/json" ||
-           mime_type == "application/javascript" || mime_type == "application/xml";
+auto tool_call_metadata(std::chrono::steady_clock::time_point start, std::size_t rss, std::optional<std::string> error)
+    -> JsonValue {
+    return NEKO_NAMESPACE::to_json_value(tool_call_info(start, rss, std::move(error)));
 }
-} // namespace
-
-namespace detail {
-auto createResourceContentsFromFile(const std::filesystem::path& path, const std::string& uri) -> ResourceContents {
-    constexpr uintmax_t max_file_size = 16 * 1024 * 1024;
-
-    try {
-        if (!std::filesystem::exists(path)) {
-            NEKO_LOG_WARN("mcp server", "Resource file not found: {}", path.string());
-            return TextResourceContents{.uri = uri, .text = "Error: File not found.", .mimeType = "text/plain"};
-        }
-
-        const auto file_size = std::filesystem::file_size(path);
-        if (file_size > max_file_size) {
-            NEKO_LOG_WARN("mcp server", "Resource file exceeds size limit ({} > {} bytes): {}", file_size,
-                          max_file_size, path.string());
-            return TextResourceContents{
-                .uri = uri, .text = "Error: File is too large to read.", .mimeType = "text/plain"};
-        }
 
-        const std::string extension = to_lower(path.extension().string());
-        const auto& mime_types      = mime_type_map();
-        const auto it               = mime_types.find(extension);
-        const std::string mime_type = (it != mime_types.end()) ? it->second : "application/octet-stream";
+/// JSON-RPC server error returned when a tool has no running slot and no queue space left.
+constexpr int kToolBusyError = -32001;
 
-        if (is_text_mime(mime_type)) {
-            std::ifstream file(path);
-            if (!file.is_open()) {
-                return TextResourceContents{
-                    .uri = uri, .text = "Error: Could not open file.", .mimeType = "text/plain"};
-            }
+/// Requests bound to the session that sent them are answered by McpServer::_route_message(), JsonRpcServer only sees
+/// them inside a batch the server does not route itself and has no session to apply them to.
+template <typename ParamsT>
+auto session_bound(ParamsT) -> ILIAS_NAMESPACE::IoTask<void> {
+    co_return ILIAS_NAMESPACE::Err(NEKO_NAMESPACE::JsonRpcError::InvalidRequest);
+}
+} // namespace
 
-            std::string text_content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-            return TextResourceContents{.uri = uri, .text = std::move(text_content), .mimeType = mime_type};
-        }
+McpServer<void>::McpServer(IoContext& ctx) : McpServer(ctx, std::make_shared<MetricsRegistry>()) {}
 
-        std::ifstream file(path, std::ios::binary);
-        if (!file.is_open()) {
-            return TextResourceContents{.uri = uri, .text = "Error: Could not open file.", .mimeType = "text/plain"};
-        }
+McpServer<void>::McpServer(IoContext& ctx, std::shared_ptr<MetricsRegistry> metrics)
+    : McpServer(ctx, std::move(metrics), detail::Registries{}) {}
 
-        std::vector<char> buffer(std::istreambuf_iterator<char>(file), {});
-        auto data = NEKO_NAMESPACE::Base64Covert::Encode(buffer);
-        return BlobResourceContents{.uri = uri, .blob = std::string(data.begin(), data.end()), .mimeType = mime_type};
-    } catch (const std::filesystem::filesystem_error& e) {
-        NEKO_LOG_ERROR("mcp server", "Filesystem error reading resource {}: {}", path.string(), e.what());
-        return TextResourceContents{.uri = uri, .text = "Error: Filesystem error.", .mimeType = "text/plain"};
-    }
+McpServer<void>::McpServer(IoContext& ctx, std::shared_ptr<MetricsRegistry> metrics, detail::Registries registries)
+    : mContext(&ctx), mServer(ctx), mToolRegistry(std::move(registries.tools)),
+      mResourceRegistry(std::move(registries.resources)), mMetrics(std::move(metrics)), mLog(ctx) {
+    _register_rpc_methods();
 }
-} // namespace detail
-
-McpServer<void>::McpServer(IoContext& ctx) : mServer(ctx) { _register_rpc_methods(); }
 
 auto McpServer<void>::setCapabilities(const ExperimentalCapabilities& capabilities) noexcept -> void {
     mCapabilities.experimental = capabilities;
@@ -135,33 +77,128 @@ auto McpServer<void>::setCapabilities(const ToolsCapability& capabilities) noexc
 
 void McpServer<void>::setInstructions(std::string_view instructions) noexcept { mInstructions = instructions; }
 
+auto McpServer<void>::setToolExecutor(std::shared_ptr<ToolExecutor> executor, bool offloadByDefault) -> void {
+    mToolExecutor     = std::move(executor);
+    mOffloadByDefault = offloadByDefault;
+}
+
+auto McpServer<void>::shouldOffload(const ToolOptions& options) const noexcept -> bool {
+    return mToolExecutor != nullptr && options.offload.value_or(mOffloadByDefault);
+}
+
+auto McpServer<void>::_sample_rss() -> Task<void> {
+    while (true) {
+        mMetrics->sampleRss();
+        if (auto ret = co_await ILIAS_NAMESPACE::sleep(mRssInterval); !ret) {
+            // Stopped by close(), the server may be gone.
+            co_return;
+        }
+    }
+}
+
+void McpServer<void>::setRssSampleInterval(std::chrono::milliseconds interval) noexcept { mRssInterval = interval; }
+
+void McpServer<void>::setProgressInterval(std::chrono::milliseconds interval) noexcept {
+    mProgressInterval = interval;
+}
+
+auto McpServer<void>::registerMetricsResource(std::string_view uri) -> void {
+    Resource resource;
+    resource.uri         = std::string(uri);
+    resource.name        = "metrics";
+    resource.description = "Per tool call counts, error counts and latency histograms in the text exposition format";
+    resource.metadata    = ResourceMetadata{.type = "metrics", .size = std::nullopt};
+    auto exposition = [metrics = mMetrics, uri = std::string(uri)](std::optional<Meta>) -> ResourceContents {
+        return TextResourceContents{.uri = uri, .text = metrics->exposition(), .mimeType = "text/plain"};
+    };
+    registerResource(std::move(resource), std::move(exposition));
+}
+
+auto McpServer<void>::_cache_ttl(const detail::RpcMethodWrapper& handler) -> std::chrono::milliseconds {
+    if (auto ttl = handler.options().cacheTtl; ttl) {
+        return *ttl;
+    }
+    const auto& annotations = handler.annotations();
+    if (annotations && (annotations->readOnlyHint.value_or(false) || annotations->idempotentHint.value_or(false))) {
+        return mCacheTtl;
+    }
+    return std::chrono::milliseconds::zero();
+}
+
+auto McpServer<void>::_results_generation(std::string_view name) const -> uint64_t {
+    // Both counters only grow, so their sum changes with either of them.
+    auto it = mToolResultsGenerations.find(name);
+    return mResultsGeneration + (it != mToolResultsGenerations.end() ? it->second : 0);
+}
+
+auto McpServer<void>::setResultCache(std::size_t maxBytes, std::chrono::milliseconds defaultTtl) -> void {
+    mResultCache.setCapacity(maxBytes);
+    mCacheTtl = defaultTtl;
+}
+
+auto McpServer<void>::invalidateToolResults(std::string_view name) -> void {
+    {
+        std::lock_guard lock(mInvalidatedMutex);
+        mInvalidatedTools.emplace_back(name);
+    }
+    _schedule_list_changed();
+}
+
+auto McpServer<void>::setToolAnnotations(std::string_view name, const ToolAnnotations& annotations) -> bool {
+    // Calls already running keep the handler they started with, the next ones see the new version.
+    const bool published = mToolRegistry->update([&](detail::ToolRegistry& registry) {
+        const auto* handler = registry.handlers.find(name);
+        if (handler == nullptr) {
+            return false;
+        }
+        return registry.handlers.replace(name, handler->withSettings(handler->options(), annotations));
+    });
+    if (!published) {
+        return false;
+    }
+    invalidateToolResults(name);
+    mToolsChanged.store(true, std::memory_order_release);
+    _schedule_list_changed();
+    return true;
+}
+
+auto McpServer<void>::setToolLimits(std::string_view name, std::size_t maxConcurrency, std::size_t maxQueue) -> bool {
+    const bool published = mToolRegistry->update([&](detail::ToolRegistry& registry) {
+        const auto* handler = registry.handlers.find(name);
+        if (handler == nullptr) {
+            return false;
+        }
+        auto options           = handler->options();
+        options.maxConcurrency = maxConcurrency;
+        options.maxQueue       = maxQueue;
+        return registry.handlers.replace(name, handler->withSettings(std::move(options), handler->annotations()));
+    });
+    if (published) {
+        // Raised limits let queued calls run, the limiter belongs to the IoContext thread.
+        mLimitsChanged.store(true, std::memory_order_release);
+        _schedule_list_changed();
+    }
+    return published;
+}
+
+void McpServer<void>::setPageSize(std::size_t pageSize) noexcept { mPageSize = pageSize; }
+
 void McpServer<void>::_register_rpc_methods() {
     mServer->initialize  = std::bind(&McpServer::_initialize, this, std::placeholders::_1);
     mServer->initialized = std::function<IoTask<void>(EmptyRequestParams)>(
         std::bind(&McpServer::_initialized, this, std::placeholders::_1));
-    mServer->toolsList     = std::bind(&McpServer::_tools_list, this, std::placeholders::_1);
-    mServer->toolsCall     = std::bind(&McpServer::_tools_call, this, std::placeholders::_1);
-    mServer->resourcesList = [this](EmptyRequestParams) -> ListResourcesResult {
-        return ListResourcesResult{.resources = mResourceList, .nextCursor = std::nullopt};
-    };
-    mServer->resourcesTemplatesList = [](EmptyRequestParams) -> ListResourceTemplatesResult {
-        return ListResourceTemplatesResult{.resourceTemplates = {}, .nextCursor = std::nullopt};
-    };
-    mServer->resourcesRead = [this](ReadResourceRequestParams request) -> ReadResourceResult {
-        ReadResourceResult result;
-        NEKO_LOG_INFO("mcp server", "read resource {}", request.uri);
-        if (auto it = mResources.find(request.uri); it != mResources.end()) {
-            result.contents.push_back(it->second(request._meta));
-        }
-        return result;
-    };
+    mServer->toolsList              = std::bind(&McpServer::_tools_list, this, std::placeholders::_1);
+    mServer->toolsCall              = std::bind(&McpServer::_tools_call, this, std::placeholders::_1);
+    mServer->resourcesList          = std::bind(&McpServer::_resources_list, this, std::placeholders::_1);
+    mServer->resourcesTemplatesList = std::bind(&McpServer::_resource_templates_list, this, std::placeholders::_1);
+    mServer->resourcesRead          = std::bind(&McpServer::_resources_read, this, std::placeholders::_1);
     mServer->ping                 = [](EmptyRequestParams) -> EmptyResult { return {}; };
     mServer->progress             = [](ProgressNotificationParams) -> void {};
     mServer->resourcesListChanged = [](EmptyRequestParams) -> void {};
-    mServer->resourcesSubscribe   = [](SubscribeRequestParams) -> void {};
-    mServer->resourcesUnsubscribe = [](UnsubscribeRequestParams) -> void {};
+    mServer->resourcesSubscribe   = std::function(&session_bound<SubscribeRequestParams>);
+    mServer->resourcesUnsubscribe = std::function(&session_bound<UnsubscribeRequestParams>);
     mServer->resourcesUpdated     = [](ResourceUpdatedNotificationParams) -> void {};
-    mServer->promptsList          = [](EmptyRequestParams) -> ListPromptsResult {
+    mServer->promptsList          = [](PaginatedRequest) -> ListPromptsResult {
         return ListPromptsResult{.prompts = {}, .nextCursor = std::nullopt};
     };
     mServer->promptsGet = [](GetPromptRequestParams) -> GetPromptResult {
@@ -169,7 +206,7 @@ void McpServer<void>::_register_rpc_methods() {
     };
     mServer->promptsListChanged = [](EmptyRequestParams) -> void {};
     mServer->toolsListChanged   = [](EmptyRequestParams) -> void {};
-    mServer->loggingSetLevel    = [](SetLevelRequestParams) -> void {};
+    mServer->loggingSetLevel    = std::function(&session_bound<SetLevelRequestParams>);
     mServer->loggingMessage     = [](LoggingMessageNotificationParams) -> void {};
     mServer->createMessage      = [](CreateMessageRequestParams) -> void {};
     mServer->completionComplete = [](CompleteRequestParams) -> CompleteResult {
@@ -197,7 +234,12 @@ auto McpServer<void>::_initialized(EmptyRequestParams) noexcept -> IoTask<void>
     co_return {};
 }
 
-auto McpServer<void>::close() -> void { mServer.close(); }
+auto McpServer<void>::close() -> void {
+    if (mRssSampler) {
+        mRssSampler.stop();
+    }
+    mServer.close();
+}
 
 auto McpServer<void>::wait() -> Task<void> { co_await mServer.wait(); }
 
@@ -205,14 +247,761 @@ auto McpServer<void>::jsonRpcServer() -> JsonRpcServer<detail::McpJsonRpcMethods
 
 auto McpServer<void>::toolsList([[maybe_unused]] const PaginatedRequest& params) -> ToolsListResult {
     ToolsListResult result;
-    for (const auto& tool : mTools) {
-        result.tools.push_back(tool());
-    }
+    mToolRegistry->load()->handlers.forEach(
+        [&](std::string_view, const detail::RpcMethodWrapper& handler) { result.tools.push_back(handler.tool()); });
     return result;
 }
 
 auto McpServer<void>::_tools_list(PaginatedRequest params) noexcept -> IoTask<ToolsListResult> {
-    co_return toolsList(params);
+    std::optional<std::string> after;
+    if (params.cursor) {
+        after = detail::decode_cursor("tools", *params.cursor);
+        if (!after) {
+            co_return ILIAS_NAMESPACE::Err(NEKO_NAMESPACE::JsonRpcError::InvalidParams);
+        }
+    }
+    co_return _tools_snapshot()->pageResult(after, mPageSize);
+}
+
+auto McpServer<void>::_resources_list(PaginatedRequest params) noexcept -> IoTask<ListResourcesResult> {
+    ListResourcesResult result;
+    const auto resources    = mResourceRegistry->load();
+    const auto& list        = resources->list;
+    const auto& directories = resources->directories;
+    auto it                 = list.begin();
+    // Registered resources come first, then the files of every directory root in registration order. A cursor into
+    // a directory holds its index and the relative path of the last file listed.
+    std::size_t directory = 0;
+    std::string after;
+    if (params.cursor) {
+        if (auto key = detail::decode_cursor("resources", *params.cursor); key) {
+            it = list.upper_bound(*key);
+        } else if (auto dirKey = detail::decode_cursor("resources/dir", *params.cursor); dirKey) {
+            const auto sep     = dirKey->find(':');
+            auto [end, ec]     = std::from_chars(dirKey->data(), dirKey->data() + dirKey->size(), directory);
+            const bool invalid = sep == std::string::npos || ec != std::errc{} || end != dirKey->data() + sep;
+            if (invalid || directory >= directories.size()) {
+                co_return ILIAS_NAMESPACE::Err(NEKO_NAMESPACE::JsonRpcError::InvalidParams);
+            }
+            it    = list.end();
+            after = dirKey->substr(sep + 1);
+        } else {
+            co_return ILIAS_NAMESPACE::Err(NEKO_NAMESPACE::JsonRpcError::InvalidParams);
+        }
+    }
+    for (; it != list.end() && (mPageSize == 0 || result.resources.size() < mPageSize); ++it) {
+        result.resources.push_back(it->second);
+    }
+    if (it != list.end()) {
+        if (!result.resources.empty()) {
+            result.nextCursor = detail::encode_cursor("resources", result.resources.back().uri);
+        }
+        co_return result;
+    }
+    for (; directory < directories.size(); ++directory, after.clear()) {
+        if (mPageSize != 0 && result.resources.size() >= mPageSize) {
+            result.nextCursor = detail::encode_cursor("resources/dir", std::to_string(directory) + ":");
+            break;
+        }
+        std::string last;
+        if (directories[directory]->list(after, mPageSize, result.resources, last)) {
+            result.nextCursor = detail::encode_cursor("resources/dir", std::to_string(directory) + ":" + last);
+            break;
+        }
+    }
+    co_return result;
+}
+
+auto McpServer<void>::_resources_read(ReadResourceRequestParams request) noexcept -> IoTask<ReadResourceResult> {
+    ReadResourceResult result;
+    mLog.log(LogLevel::Debug, "resources", "read resource {}", request.uri);
+    auto resources     = mResourceRegistry->load();
+    auto [path, range] = detail::split_byte_range(request.uri);
+    if (auto it = resources->contents.find(request.uri); it != resources->contents.end()) {
+        result.contents.push_back(it->second(request._meta));
+    } else if (auto file = _find_file_resource(*resources, path); file) {
+        if (range) {
+            co_return detail::read_file_range(*file, std::string(path), *range);
+        }
+        result.contents.push_back(detail::read_file_resource(*file, request.uri, &mFileCache));
+    } else if (auto match = resources->templates.match(request.uri); match) {
+        // The snapshot keeps the handler alive while the provider runs.
+        const auto& handler = *resources->templateResources[match->value].handler;
+        auto contents       = co_await handler(request.uri, std::move(match->variables));
+        if (!contents) {
+            co_return ILIAS_NAMESPACE::Err(contents.error());
+        }
+        result.contents.push_back(std::move(*contents));
+    }
+    co_return result;
+}
+
+auto McpServer<void>::_resource_templates_list(PaginatedRequest params) noexcept
+    -> IoTask<ListResourceTemplatesResult> {
+    ListResourceTemplatesResult result{.resourceTemplates = {}, .nextCursor = std::nullopt};
+    const auto resources = mResourceRegistry->load();
+    // Templates are only ever appended, a cursor holds the uriTemplate of the last one listed.
+    ResourceTemplate files;
+    std::vector<const ResourceTemplate*> templates;
+    templates.reserve(resources->templateResources.size() + 1);
+    if (!resources->directories.empty()) {
+        files.uriTemplate = "file:///{path}";
+        files.name        = "files";
+        files.description = "Files below the registered directories";
+        templates.push_back(&files);
+    }
+    for (const auto& resource : resources->templateResources) {
+        templates.push_back(&resource.resourceTemplate);
+    }
+    auto it = templates.begin();
+    if (params.cursor) {
+        auto after = detail::decode_cursor("resources/templates", *params.cursor);
+        if (!after) {
+            co_return ILIAS_NAMESPACE::Err(NEKO_NAMESPACE::JsonRpcError::InvalidParams);
+        }
+        it = std::find_if(templates.begin(), templates.end(),
+                          [&](const ResourceTemplate* entry) { return entry->uriTemplate == *after; });
+        if (it == templates.end()) {
+            co_return ILIAS_NAMESPACE::Err(NEKO_NAMESPACE::JsonRpcError::InvalidParams);
+        }
+        ++it;
+    }
+    for (; it != templates.end() && (mPageSize == 0 || result.resourceTemplates.size() < mPageSize); ++it) {
+        result.resourceTemplates.push_back(**it);
+    }
+    if (it != templates.end() && !result.resourceTemplates.empty()) {
+        result.nextCursor = detail::encode_cursor("resources/templates", result.resourceTemplates.back().uriTemplate);
+    }
+    co_return result;
+}
+
+auto McpServer<void>::_tools_snapshot() -> std::shared_ptr<const detail::ToolCatalog::Snapshot> {
+    // Tools published by another server sharing the registry only show up in its version.
+    const auto version = mToolRegistry->version();
+    if (!mToolCatalog.isStale(version)) {
+        return mToolCatalog.snapshot();
+    }
+    const bool listed = mToolCatalog.snapshot() != nullptr;
+    auto snapshot     = mToolCatalog.update(toolsList(PaginatedRequest{}), version);
+    if (listed && mCapabilities.tools && mCapabilities.tools->listChanged.value_or(false)) {
+        notify("notifications/tools/list_changed", EmptyRequestParams{});
+    }
+    return snapshot;
+}
+
+auto McpServer<void>::_invalidate_tools() -> void {
+    mToolCatalog.invalidate();
+    // Nobody has seen the list yet, the first tools/list builds it.
+    if (mToolCatalog.snapshot()) {
+        (void)_tools_snapshot();
+    }
+}
+
+namespace detail {
+auto publish_tool(SnapshotCell<ToolRegistry>& tools, MetricsRegistry& metrics, std::string_view name,
+                  std::shared_ptr<RpcMethodWrapper> handler) -> bool {
+    handler->metrics = &metrics.tool(name);
+    return tools.update([&](ToolRegistry& registry) { return registry.handlers.insert(name, std::move(handler)); });
+}
+
+auto publish_resource(SnapshotCell<ResourceRegistry>& resources, Resource resource,
+                      std::function<ResourceContents(std::optional<Meta> meta)> contents) -> bool {
+    auto uri      = resource.uri;
+    bool replaced = false;
+    resources.update([&](ResourceRegistry& registry) {
+        replaced = registry.list.contains(uri);
+        registry.contents.insert_or_assign(uri, std::move(contents));
+        registry.files.erase(uri);
+        registry.list.insert_or_assign(uri, std::move(resource));
+        return true;
+    });
+    return replaced;
+}
+} // namespace detail
+
+auto McpServer<void>::_publish_tool(std::string_view name, std::shared_ptr<detail::RpcMethodWrapper> handler)
+    -> bool {
+    const bool published = detail::publish_tool(*mToolRegistry, *mMetrics, name, std::move(handler));
+    if (published) {
+        mToolsChanged.store(true, std::memory_order_release);
+        _schedule_list_changed();
+    }
+    return published;
+}
+
+auto McpServer<void>::_registries_changed(bool tools, bool resources) -> void {
+    if (tools) {
+        mToolsChanged.store(true, std::memory_order_release);
+    }
+    if (resources) {
+        mResourcesChanged.store(true, std::memory_order_release);
+    }
+    _schedule_list_changed();
+}
+
+auto McpServer<void>::_limiter(std::string_view name) -> detail::ToolLimiter& {
+    // Per server, the limiter belongs to the IoContext thread even when the handlers are shared.
+    if (auto it = mLimiters.find(name); it != mLimiters.end()) {
+        return it->second;
+    }
+    return mLimiters.try_emplace(std::string(name)).first->second;
+}
+
+auto McpServer<void>::_schedule_list_changed() -> void {
+    // Registration may come from any thread, sessions and the tool catalog belong to the IoContext thread.
+    if (!mListChangedPosted.exchange(true, std::memory_order_acq_rel)) {
+        mPosts.post<&McpServer::_on_list_changed>(*mContext);
+    }
+}
+
+auto McpServer<void>::_on_list_changed(void* self) -> void {
+    auto& server = *static_cast<McpServer*>(self);
+    server.mListChangedPosted.store(false, std::memory_order_release);
+    if (server.mToolsChanged.exchange(false, std::memory_order_acq_rel)) {
+        server._invalidate_tools();
+    }
+    if (server.mLimitsChanged.exchange(false, std::memory_order_acq_rel)) {
+        server.mToolRegistry->load()->handlers.forEach(
+            [&](std::string_view name, const detail::RpcMethodWrapper& handler) {
+                if (auto it = server.mLimiters.find(name); it != server.mLimiters.end()) {
+                    it->second.wake(*server.mContext, handler.options().maxConcurrency);
+                }
+            });
+    }
+    std::vector<std::string> invalidated;
+    {
+        std::lock_guard lock(server.mInvalidatedMutex);
+        invalidated.swap(server.mInvalidatedTools);
+    }
+    for (const auto& name : invalidated) {
+        if (name.empty()) {
+            ++server.mResultsGeneration;
+            server.mResultCache.clear();
+        } else {
+            ++server.mToolResultsGenerations[name];
+            server.mResultCache.invalidate(name);
+        }
+    }
+    if (server.mResourcesChanged.exchange(false, std::memory_order_acq_rel) && server.mCapabilities.resources &&
+        server.mCapabilities.resources->listChanged.value_or(false)) {
+        server.notify("notifications/resources/list_changed", EmptyRequestParams{});
+    }
+}
+
+auto McpServer<void>::_broadcast(std::shared_ptr<const std::string> message) -> void {
+    std::erase_if(mSessions, [](const std::weak_ptr<detail::McpSession>& session) {
+        auto ptr = session.lock();
+        return !ptr || ptr->isClosed();
+    });
+    for (const auto& session : mSessions) {
+        if (auto ptr = session.lock(); ptr) {
+            ptr->post(message);
+        }
+    }
+}
+
+auto McpServer<void>::_route_message(const std::shared_ptr<detail::McpSession>& session,
+                                     std::vector<std::byte>& buffer) -> bool {
+    const auto text = std::string_view(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    if (auto pos = detail::json_skip_ws(text, 0); pos < text.size() && text[pos] == '[') {
+        return _route_batch(session, buffer);
+    }
+    auto message = RawMessage::parse(text);
+    if (!message) {
+        return false;
+    }
+    if (message->isNotification()) {
+        if (message->method == "notifications/cancelled") {
+            // JsonRpcServer still sees the notification for the requests it runs itself.
+            if (auto requestId = detail::json_member(message->params, "requestId"); requestId) {
+                session->cancel(*requestId);
+            }
+        }
+        return false;
+    }
+    if (message->method == "tools/call") {
+        auto [handler, name] = _raw_tool(*message);
+        if (handler == nullptr) {
+            return false;
+        }
+        // The slices in `message` point into `buffer`, the task takes the buffer over instead of copying the request.
+        _start_tools_call(session, detail::Responder{.session = session},
+                          std::make_shared<std::vector<std::byte>>(std::move(buffer)), *message, std::move(handler),
+                          name);
+        return true;
+    }
+    if (message->method == "tools/list") {
+        _reply_tools_list(detail::Responder{.session = session}, *message);
+        return true;
+    }
+    if (message->method == "resources/read") {
+        return _reply_file_resource(detail::Responder{.session = session}, *message);
+    }
+    if (message->method == "resources/subscribe" || message->method == "resources/unsubscribe") {
+        // Subscriptions belong to the session, JsonRpcServer handlers do not know which one sent the request.
+        _subscribe(session, detail::Responder{.session = session}, *message);
+        return true;
+    }
+    if (message->method == "logging/setLevel") {
+        // The level belongs to the session, JsonRpcServer handlers do not know which one sent the request.
+        _set_log_level(session, detail::Responder{.session = session}, *message);
+        return true;
+    }
+    return false;
+}
+
+auto McpServer<void>::_route_batch(const std::shared_ptr<detail::McpSession>& session,
+                                   std::vector<std::byte>& buffer) -> bool {
+    const auto text = std::string_view(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    auto elements   = detail::json_elements(text);
+    if (!elements || elements->empty()) {
+        return false;
+    }
+    // The whole batch is taken over only if every element can be answered here, a batch mixing in other methods goes
+    // to JsonRpcServer untouched.
+    std::vector<RawMessage> messages;
+    std::vector<std::pair<std::shared_ptr<detail::RpcMethodWrapper>, std::string_view>> tools(elements->size());
+    messages.reserve(elements->size());
+    for (std::size_t idx = 0; idx < elements->size(); ++idx) {
+        auto message = RawMessage::parse((*elements)[idx]);
+        if (!message) {
+            return false;
+        }
+        if (message->isNotification()) {
+            if (message->method != "notifications/cancelled") {
+                return false;
+            }
+        } else if (message->method == "tools/call") {
+            tools[idx] = _raw_tool(*message);
+            if (tools[idx].first == nullptr) {
+                return false;
+            }
+        } else if (message->method != "tools/list" && message->method != "logging/setLevel" &&
+                   message->method != "resources/subscribe" && message->method != "resources/unsubscribe") {
+            return false;
+        }
+        messages.push_back(*message);
+    }
+    auto request = std::make_shared<std::vector<std::byte>>(std::move(buffer));
+    auto batch   = std::make_shared<detail::BatchReply>(session, messages.size());
+    for (std::size_t idx = 0; idx < messages.size(); ++idx) {
+        const auto& message = messages[idx];
+        detail::Responder responder{.session = session, .batch = batch, .index = idx};
+        if (message.isNotification()) {
+            if (auto requestId = detail::json_member(message.params, "requestId"); requestId) {
+                session->cancel(*requestId);
+            }
+            responder.drop();
+        } else if (message.method == "tools/list") {
+            _reply_tools_list(responder, message);
+        } else if (message.method == "logging/setLevel") {
+            _set_log_level(session, responder, message);
+        } else if (message.method == "resources/subscribe" || message.method == "resources/unsubscribe") {
+            _subscribe(session, responder, message);
+        } else {
+            // Every call runs in its own task, the batch is answered when the slowest one is done.
+            _start_tools_call(session, std::move(responder), request, message, std::move(tools[idx].first),
+                              tools[idx].second);
+        }
+    }
+    return true;
+}
+
+auto McpServer<void>::_resource_uri(const RawMessage& message) -> std::optional<std::string_view> {
+    auto raw = detail::json_member(message.params, "uri");
+    if (!raw) {
+        return std::nullopt;
+    }
+    return detail::json_plain_string(*raw);
+}
+
+auto McpServer<void>::_reply_file_resource(const detail::Responder& responder, const RawMessage& message) -> bool {
+    auto uri = _resource_uri(message);
+    if (!uri) {
+        return false;
+    }
+    auto [path, range] = detail::split_byte_range(*uri);
+    auto file          = _find_file_resource(*mResourceRegistry->load(), path);
+    if (!file) {
+        return false;
+    }
+    if (!range) {
+        range = _meta_range(message);
+    }
+    mLog.log(LogLevel::Debug, "resources", "read resource {}", *uri);
+    // The file goes from its view into the response, without a ReadResourceResult in between. A range reads only the
+    // pages it covers, so the tail of a huge log is read and encoded without the rest of it.
+    std::string reply;
+    reply.append(R"({"jsonrpc":"2.0","id":)").append(message.id).append(R"(,"result":)");
+    if (range) {
+        detail::append_file_range_result(reply, *file, path, *range);
+    } else {
+        detail::append_file_resource_result(reply, *file, *uri, &mFileCache);
+    }
+    reply.push_back('}');
+    responder.reply(std::move(reply));
+    return true;
+}
+
+auto McpServer<void>::_meta_range(const RawMessage& message) -> std::optional<detail::ByteRange> {
+    auto meta = detail::json_member(message.params, "_meta");
+    if (!meta) {
+        return std::nullopt;
+    }
+    auto parse = [&](std::string_view key) -> std::optional<std::uintmax_t> {
+        auto raw             = detail::json_member(*meta, key);
+        std::uintmax_t value = 0;
+        if (!raw || std::from_chars(raw->data(), raw->data() + raw->size(), value).ec != std::errc{}) {
+            return std::nullopt;
+        }
+        return value;
+    };
+    auto offset = parse("offset");
+    auto length = parse("length");
+    if (!offset && !length) {
+        return std::nullopt;
+    }
+    return detail::ByteRange{.offset = offset.value_or(0), .length = length, .fromEnd = false};
+}
+
+auto McpServer<void>::_find_file_resource(const detail::ResourceRegistry& resources, std::string_view uri)
+    -> std::shared_ptr<const detail::LocalFileResource> {
+    if (auto it = resources.files.find(uri); it != resources.files.end()) {
+        return it->second;
+    }
+    // A resource registered under the same URI shadows the directory, its reads go through JsonRpcServer.
+    if (resources.contents.contains(uri)) {
+        return nullptr;
+    }
+    for (const auto& directory : resources.directories) {
+        if (auto file = directory->resolve(uri); file) {
+            return std::make_shared<const detail::LocalFileResource>(std::move(*file));
+        }
+    }
+    return nullptr;
+}
+
+auto McpServer<void>::_subscribe(const std::shared_ptr<detail::McpSession>& session,
+                                 const detail::Responder& responder, const RawMessage& message) -> void {
+    const auto uri = _resource_uri(message);
+    if (!uri) {
+        responder.reply(detail::make_raw_error(message.id, -32602, "Invalid uri"));
+        return;
+    }
+    if (message.method == "resources/subscribe") {
+        mSubscriptions.subscribe(session, *uri);
+    } else {
+        mSubscriptions.unsubscribe(*session, *uri);
+    }
+    responder.reply(detail::make_raw_result(message.id, "{}"));
+}
+
+auto McpServer<void>::_close_session(detail::McpSession& session) -> void { mSubscriptions.removeSession(session); }
+
+auto McpServer<void>::notifyResourceUpdated(std::string_view uri) -> void {
+    {
+        std::lock_guard lock(mUpdatedMutex);
+        mUpdatedResources.emplace_back(uri);
+    }
+    if (!mUpdatedPosted.exchange(true, std::memory_order_acq_rel)) {
+        mPosts.post<&McpServer::_on_resources_updated>(*mContext);
+    }
+}
+
+auto McpServer<void>::_on_resources_updated(void* self) -> void {
+    auto& server = *static_cast<McpServer*>(self);
+    server.mUpdatedPosted.store(false, std::memory_order_release);
+    std::vector<std::string> uris;
+    {
+        std::lock_guard lock(server.mUpdatedMutex);
+        uris.swap(server.mUpdatedResources);
+    }
+    std::sort(uris.begin(), uris.end());
+    uris.erase(std::unique(uris.begin(), uris.end()), uris.end());
+    for (const auto& uri : uris) {
+        if (!server.mSubscriptions.subscribed(uri)) {
+            continue;
+        }
+        // Serialized once, every subscribed session writes the same buffer.
+        std::string message(R"({"jsonrpc":"2.0","method":"notifications/resources/updated","params":{"uri":)");
+        detail::json_append_string(message, uri);
+        message.append("}}");
+        server.mSubscriptions.publish(uri, std::make_shared<const std::string>(std::move(message)));
+    }
+}
+
+auto McpServer<void>::_set_log_level(const std::shared_ptr<detail::McpSession>& session,
+                                     const detail::Responder& responder, const RawMessage& message) -> void {
+    std::optional<LogLevel> level;
+    if (auto raw = detail::json_member(message.params, "level"); raw) {
+        if (auto name = detail::json_plain_string(*raw); name) {
+            level = log_level_from_string(*name);
+        }
+    }
+    if (!level) {
+        responder.reply(detail::make_raw_error(message.id, -32602, "Invalid level"));
+        return;
+    }
+    mLog.setLevel(session, *level);
+    responder.reply(detail::make_raw_result(message.id, "{}"));
+}
+
+auto McpServer<void>::_raw_tool(const RawMessage& message)
+    -> std::pair<std::shared_ptr<detail::RpcMethodWrapper>, std::string_view> {
+    auto name = detail::json_member(message.params, "name");
+    if (!name) {
+        return {};
+    }
+    auto plainName = detail::json_plain_string(*name);
+    if (!plainName) {
+        return {};
+    }
+    // The call keeps the version of the handler it started with, even if new settings are published meanwhile.
+    auto handler = mToolRegistry->load()->handlers.get(*plainName);
+    if (handler == nullptr || !handler->acceptsRawArguments()) {
+        return {};
+    }
+    return {std::move(handler), *plainName};
+}
+
+auto McpServer<void>::_start_tools_call(const std::shared_ptr<detail::McpSession>& session,
+                                        detail::Responder responder, std::shared_ptr<std::vector<std::byte>> buffer,
+                                        const RawMessage& message, std::shared_ptr<detail::RpcMethodWrapper> handler,
+                                        std::string_view name) -> void {
+    auto& metrics       = *handler->metrics;
+    const bool cached   = mResultCache.enabled() && _cache_ttl(*handler) > std::chrono::milliseconds::zero();
+    const bool coalesce = handler->options().coalesce;
+    std::string key;
+    if (cached || coalesce) {
+        auto arguments = detail::json_member(message.params, "arguments").value_or(std::string_view{});
+        key            = detail::ToolResultCache::makeKey(name, arguments);
+    }
+    if (cached && !key.empty()) {
+        if (auto result = mResultCache.find(key); result) {
+            metrics.record(0, false);
+            responder.reply(detail::make_raw_result(message.id, *result));
+            return;
+        }
+    }
+    if (coalesce && !key.empty()) {
+        if (auto it = mSharedCalls.find(key); it != mSharedCalls.end()) {
+            _join_shared_call(it->second, session, std::move(responder), message.id);
+            return;
+        }
+    }
+    auto admission = _limiter(name).tryAdmit(handler->options().maxConcurrency, handler->options().maxQueue);
+    if (!admission) {
+        std::string error = "Tool ";
+        error.append(name).append(" is busy");
+        responder.reply(detail::make_raw_error(message.id, kToolBusyError, error));
+        return;
+    }
+    std::shared_ptr<detail::SharedToolCall> shared;
+    if (coalesce && !key.empty()) {
+        shared      = std::make_shared<detail::SharedToolCall>();
+        shared->key = key;
+        mSharedCalls.emplace(key, shared);
+        _join_shared_call(shared, session, responder, message.id);
+    }
+    std::stop_source stop = shared ? shared->stop : std::stop_source();
+    if (!shared) {
+        session->beginRequest(message.id, stop);
+    }
+    auto id     = std::string(message.id);
+    auto batch  = responder.batch;
+    auto index  = responder.index;
+    auto handle = ILIAS_NAMESPACE::spawn(_tools_call_raw(std::move(responder), std::move(buffer), message,
+                                                         std::move(handler), name, std::move(admission),
+                                                         cached ? std::move(key) : std::string{},
+                                                         _results_generation(name), shared, stop));
+    if (shared) {
+        shared->handle = std::move(handle);
+    } else if (batch) {
+        // A stopped task may never answer, its slot is settled here so the rest of the batch is still sent.
+        session->attachRequest(id, [batch, index, handle = std::make_shared<ScopedCancelHandle>(std::move(handle))]() {
+            batch->skip(index);
+            if (*handle) {
+                handle->stop();
+            }
+        });
+    } else {
+        session->attachRequest(id, std::move(handle));
+    }
+}
+
+auto McpServer<void>::_join_shared_call(const std::shared_ptr<detail::SharedToolCall>& shared,
+                                        const std::shared_ptr<detail::McpSession>& session,
+                                        detail::Responder responder, std::string_view id) -> void {
+    session->beginRequest(id);
+    session->attachRequest(id, [this, weakShared = std::weak_ptr(shared), weakSession = std::weak_ptr(session),
+                                batch = responder.batch, index = responder.index, id = std::string(id)]() {
+        auto shared  = weakShared.lock();
+        auto session = weakSession.lock();
+        if (!shared || !session) {
+            return;
+        }
+        session->endRequest(id);
+        if (batch) {
+            batch->skip(index);
+        }
+        if (!shared->leave(*session, id)) {
+            return;
+        }
+        // Last caller gone, later identical calls must not join an execution that is being stopped.
+        if (auto it = mSharedCalls.find(shared->key); it != mSharedCalls.end() && it->second == shared) {
+            mSharedCalls.erase(it);
+        }
+        shared->stop.request_stop();
+        if (shared->handle) {
+            shared->handle.stop();
+        }
+    });
+    shared->join(std::move(responder), id);
+}
+
+auto McpServer<void>::_tools_call_raw(detail::Responder responder,
+                                      [[maybe_unused]] std::shared_ptr<std::vector<std::byte>> buffer,
+                                      RawMessage message, std::shared_ptr<detail::RpcMethodWrapper> handler,
+                                      std::string_view name, detail::ToolLimiter::Admission admission,
+                                      std::string cacheKey, uint64_t generation,
+                                      std::shared_ptr<detail::SharedToolCall> shared, std::stop_source stop)
+    -> Task<void> {
+    auto time      = std::chrono::steady_clock::now();
+    auto arguments = detail::json_member(message.params, "arguments").value_or(std::string_view{});
+    auto meta      = detail::json_member(message.params, "_meta");
+    // The content is serialized straight into the JSON-RPC message handed to the session, the CallToolResult around it
+    // is written in place. There is no per request arena: the arguments are parsed by nekoproto into standard
+    // containers, which take no allocator, and this one string is the only allocation the reply needs.
+    std::string reply(R"({"jsonrpc":"2.0","id":)");
+    reply.append(message.id).append(R"(,"result":)");
+    const auto resultStart = reply.size();
+    reply.append(R"({"content":)");
+    const auto contentStart = reply.size();
+    bool isError            = true;
+    std::optional<std::string> error;
+    // Progress of a coalesced call goes to the caller that started it, the others only get the result.
+    std::optional<detail::ProgressReporter> progress;
+    if (meta) {
+        if (auto token = detail::json_member(*meta, "progressToken"); token && *token != "null") {
+            progress.emplace(responder.session, std::string(*token), mProgressInterval);
+        }
+    }
+    // The deadline runs from here, the time spent queued for a running slot counts.
+    auto context = detail::ToolCallContext{
+        .progress = progress ? &*progress : nullptr, .stop = stop.get_token(), .server = this};
+    auto call    = _admitted(_limiter(name), handler->options().maxConcurrency, std::move(admission),
+                             stop.get_token(), handler->callJson(arguments, std::move(context), reply));
+    auto ret     = co_await _await_tool(std::move(call), stop, _tool_timeout(*handler, meta));
+    if (ret) {
+        isError = ret.value();
+    } else if (ret.error() == IliasError::TimedOut) {
+        error = "Tool call timed out";
+    }
+    handler->metrics->record(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - time).count(),
+        isError);
+    if (reply.size() == contentStart) {
+        reply.append("[]");
+    }
+    reply.append(isError ? R"(,"isError":true)" : R"(,"isError":false)");
+    // Results dropped while the call ran may be what it computed from, it is not cached then.
+    if (!cacheKey.empty() && !isError && generation == _results_generation(name)) {
+        // Cached without the per call metadata, which would be stale on a hit.
+        auto cached = std::make_shared<std::string>(std::string_view(reply).substr(resultStart));
+        cached->push_back('}');
+        mResultCache.insert(std::move(cacheKey), std::move(cached), _cache_ttl(*handler));
+    }
+    reply.append(R"(,"metadata":)")
+        .append(detail::serialize_json(tool_call_info(time, mMetrics->rss(), std::move(error))))
+        .push_back('}');
+    if (!shared) {
+        if (auto session = responder.session.lock(); session) {
+            session->endRequest(message.id);
+        }
+        reply.push_back('}');
+        responder.reply(std::move(reply));
+        co_return;
+    }
+    if (auto it = mSharedCalls.find(shared->key); it != mSharedCalls.end() && it->second == shared) {
+        mSharedCalls.erase(it);
+    }
+    // Every caller of a coalesced call has its own id, they get the result wrapped in their own message.
+    const auto result = std::string_view(reply).substr(resultStart);
+    for (const auto& caller : shared->callers) {
+        if (auto session = caller.responder.session.lock(); session) {
+            session->endRequest(caller.id);
+        }
+        caller.responder.reply(detail::make_raw_result(caller.id, result));
+    }
+}
+
+template <typename T>
+auto McpServer<void>::_await_tool(IoTask<T> call, std::stop_source stop,
+                                  std::optional<std::chrono::milliseconds> timeout) -> IoTask<T> {
+    if (!timeout) {
+        co_return co_await std::move(call);
+    }
+    // Stopping the call interrupts its coroutine, an offloaded tool is detached and keeps running on the executor, a
+    // synchronous tool run inline has to see the stop token and return.
+    auto [ret, expired] = co_await ILIAS_NAMESPACE::whenAny(std::move(call), _expire(std::move(stop), *timeout));
+    // A call stopped by the deadline ends with Canceled, which is reported as the deadline.
+    if (ret && (*ret || !expired)) {
+        co_return std::move(*ret);
+    }
+    co_return ILIAS_NAMESPACE::Err(IliasError::TimedOut);
+}
+
+template <typename T>
+auto McpServer<void>::_admitted(detail::ToolLimiter& limiter, std::size_t maxConcurrency,
+                                detail::ToolLimiter::Admission admission, std::stop_token stop, IoTask<T> call)
+    -> IoTask<T> {
+    auto permit = co_await limiter.acquire(std::move(admission), *mContext, maxConcurrency, std::move(stop));
+    if (!permit) {
+        co_return ILIAS_NAMESPACE::Err(permit.error());
+    }
+    co_return co_await std::move(call);
+}
+
+auto McpServer<void>::_expire(std::stop_source stop, std::chrono::milliseconds timeout) -> IoTask<void> {
+    if (auto ret = co_await ILIAS_NAMESPACE::sleep(timeout); !ret) {
+        co_return ILIAS_NAMESPACE::Err(ret.error());
+    }
+    stop.request_stop();
+    co_return {};
+}
+
+auto McpServer<void>::_tool_timeout(const detail::RpcMethodWrapper& handler, std::optional<std::string_view> meta)
+    -> std::optional<std::chrono::milliseconds> {
+    auto timeout = handler.options().timeout;
+    if (!meta) {
+        return timeout;
+    }
+    auto value = detail::json_member(*meta, "timeout");
+    if (!value) {
+        return timeout;
+    }
+    // A request can only shorten the deadline configured for the tool.
+    int64_t millis = 0;
+    if (auto [ptr, ec] = std::from_chars(value->data(), value->data() + value->size(), millis);
+        ec != std::errc{} || millis <= 0) {
+        return timeout;
+    }
+    auto requested = std::chrono::milliseconds(millis);
+    return timeout ? std::min(*timeout, requested) : requested;
+}
+
+auto McpServer<void>::_reply_tools_list(const detail::Responder& responder, const RawMessage& message) -> void {
+    std::optional<std::string> after;
+    if (auto cursor = detail::json_member(message.params, "cursor"); cursor && *cursor != "null") {
+        if (auto text = detail::json_plain_string(*cursor); text) {
+            after = detail::decode_cursor("tools", *text);
+        }
+        if (!after) {
+            responder.reply(detail::make_raw_error(message.id, -32602, "Invalid cursor"));
+            return;
+        }
+    }
+    responder.reply(detail::make_raw_result(message.id, _tools_snapshot()->pageJson(after, mPageSize)));
 }
 
 auto McpServer<void>::_cancelled(CancelledNotificationParams params) noexcept -> IoTask<void> {
@@ -232,28 +1021,43 @@ auto McpServer<void>::_cancelled(CancelledNotificationParams params) noexcept ->
 }
 
 auto McpServer<void>::_tools_call(ToolCallRequestParams params) noexcept -> IoTask<CallToolResult> {
-    auto time = std::chrono::high_resolution_clock::now();
+    auto time = std::chrono::steady_clock::now();
     CallToolResult result{.content = {}, .isError = true, .metadata = {}};
-    ToolCallInfo info;
-    if (auto item = mHandlers.find(params.name); item != mHandlers.end()) {
-        JsonSerializer::InputSerializer in(params.arguments);
-        if (auto ret = co_await (*item->second)(in); ret) {
-            result = ret.value();
+    std::optional<std::string> error;
+    if (auto handler = mToolRegistry->load()->handlers.get(params.name); handler != nullptr) {
+        auto& metrics = *handler->metrics;
+        auto& options = handler->options();
+        auto& limiter = _limiter(params.name);
+        if (auto admission = limiter.tryAdmit(options.maxConcurrency, options.maxQueue); admission) {
+            JsonSerializer::InputSerializer in(params.arguments);
+            std::stop_source stop;
+            auto call = _admitted(limiter, options.maxConcurrency, std::move(admission), stop.get_token(),
+                                  handler->call(in, {.stop = stop.get_token(), .server = this}));
+            auto ret  = co_await _await_tool(std::move(call), stop, options.timeout);
+            if (ret) {
+                result = ret.value();
+            } else {
+                result.isError = true;
+                if (ret.error() == IliasError::TimedOut) {
+                    error = "Tool " + params.name + " timed out";
+                }
+            }
         } else {
-            result.isError = true;
+            error = "Tool " + params.name + " is busy";
         }
+        metrics.record(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - time).count(),
+            result.isError);
     } else {
-        info.error = "Tool " + params.name + " not found";
+        error = "Tool " + params.name + " not found";
     }
-    info.executionTime =
-        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - time).count();
-    info.resourceUsage.memory = std::to_string(getCurrentRSS() / 1024) + "KB";
-    result.metadata           = NEKO_NAMESPACE::to_json_value(info);
+    result.metadata = tool_call_metadata(time, mMetrics->rss(), std::move(error));
     co_return result;
 }
 
 auto McpServer<void>::registerLocalFileResource(std::string_view name, std::filesystem::path path, std::string_view uri,
-                                                std::string_view description) -> bool {
+                                                std::string_view description, const FileResourceOptions& options)
+    -> bool {
     if (!std::filesystem::exists(path)) {
         return false;
     }
@@ -264,9 +1068,66 @@ auto McpServer<void>::registerLocalFileResource(std::string_view name, std::file
         resource.description = std::string(description);
     }
     resource.metadata = ResourceMetadata{.type = "file", .size = std::filesystem::file_size(path)};
-    registerResource(resource, [path = std::move(path), uri = resource.uri](std::optional<Meta>) -> ResourceContents {
-        return detail::createResourceContentsFromFile(path, uri);
+    detail::LocalFileResource local{
+        .path = path, .mimeType = detail::file_mime_type(path), .maxSize = options.maxSize, .mapped = options.mapped};
+    auto file = std::make_shared<const detail::LocalFileResource>(std::move(local));
+    auto key      = resource.uri;
+    bool replaced = false;
+    mResourceRegistry->update([&](detail::ResourceRegistry& registry) {
+        replaced = registry.list.contains(key);
+        // Read through `files` with the cache of the server serving the request.
+        registry.contents.erase(key);
+        registry.files.insert_or_assign(key, file);
+        registry.list.insert_or_assign(key, std::move(resource));
+        return true;
+    });
+    if (replaced) {
+        notifyResourceUpdated(key);
+    }
+    mResourcesChanged.store(true, std::memory_order_release);
+    _schedule_list_changed();
+    return true;
+}
+
+auto McpServer<void>::registerResourceTemplate(ResourceTemplate resourceTemplate, ResourceTemplateHandler handler)
+    -> bool {
+    auto shared           = std::make_shared<const ResourceTemplateHandler>(std::move(handler));
+    const bool registered = mResourceRegistry->update([&](detail::ResourceRegistry& registry) {
+        if (!registry.templates.insert(resourceTemplate.uriTemplate, registry.templateResources.size())) {
+            return false;
+        }
+        registry.templateResources.push_back(
+            detail::TemplateResource{.resourceTemplate = std::move(resourceTemplate), .handler = std::move(shared)});
+        return true;
+    });
+    if (registered) {
+        mResourcesChanged.store(true, std::memory_order_release);
+        _schedule_list_changed();
+    }
+    return registered;
+}
+
+auto McpServer<void>::registerDirectoryResource(std::filesystem::path root, const FileResourceOptions& options)
+    -> bool {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root, ec)) {
+        return false;
+    }
+    auto directory       = std::make_shared<detail::DirectoryIndex>(std::move(root), options);
+    const bool published = mResourceRegistry->update([&](detail::ResourceRegistry& registry) {
+        // Servers sharing the registry may all register the same root.
+        for (const auto& registered : registry.directories) {
+            if (registered->root() == directory->root()) {
+                return false;
+            }
+        }
+        registry.directories.push_back(directory);
+        return true;
     });
+    if (published) {
+        mResourcesChanged.store(true, std::memory_order_release);
+        _schedule_list_changed();
+    }
     return true;
 }
 
@@ -277,8 +1138,12 @@ auto McpServer<void>::registerResource(Resource resource, ResourceContents conte
 
 auto McpServer<void>::registerResource(Resource resource, std::function<ResourceContents(std::optional<Meta>)> contents)
     -> void {
-    mResources[resource.uri] = std::move(contents);
-    mResourceList.push_back(std::move(resource));
+    auto uri = resource.uri;
+    if (detail::publish_resource(*mResourceRegistry, std::move(resource), std::move(contents))) {
+        notifyResourceUpdated(uri);
+    }
+    mResourcesChanged.store(true, std::memory_order_release);
+    _schedule_list_changed();
 }
 
 CCMCP_EN
@@ -0,0 +1,110 @@
+#include "ccmcp/server/session.hpp"
+
+#include <nekoproto/global/log.hpp>
+
+CCMCP_BN
+
+namespace detail {
+auto McpSession::post(std::shared_ptr<const std::string> message) -> void {
+    if (mClosed || !message) {
+        return;
+    }
+    mPending.push_back(std::move(message));
+    if (mWriting) {
+        return;
+    }
+    mWriting = true;
+    (void)ILIAS_NAMESPACE::spawn(_flush_posted(shared_from_this()));
+}
+
+auto McpSession::send(std::span<const std::byte> data) -> IoTask<void> {
+    if (mClosed) {
+        co_return ILIAS_NAMESPACE::Err(ILIAS_NAMESPACE::IoError::Canceled);
+    }
+    if (mWriting) {
+        mPending.push_back(std::make_shared<const std::string>(reinterpret_cast<const char*>(data.data()), data.size()));
+        co_return {};
+    }
+    mWriting = true;
+    auto ret = co_await write(data);
+    if (ret) {
+        ret = co_await _write_pending();
+    }
+    mWriting = false;
+    co_return ret;
+}
+
+auto McpSession::beginRequest(std::string_view id, std::stop_source stop) -> void {
+    // A client reusing the id of a request still running takes the entry over, the older one can no longer be
+    // cancelled by id anyway.
+    mInflight.insert_or_assign(std::string(id), Inflight{.stop = std::move(stop)});
+}
+
+auto McpSession::attachRequest(std::string_view id, ILIAS_NAMESPACE::StopHandle handle) -> void {
+    if (auto it = mInflight.find(id); it != mInflight.end()) {
+        it->second.handle = std::move(handle);
+    }
+}
+
+auto McpSession::attachRequest(std::string_view id, std::function<void()> onCancel) -> void {
+    if (auto it = mInflight.find(id); it != mInflight.end()) {
+        it->second.onCancel = std::move(onCancel);
+    }
+}
+
+auto McpSession::endRequest(std::string_view id) -> void {
+    if (auto it = mInflight.find(id); it != mInflight.end()) {
+        mInflight.erase(it);
+    }
+}
+
+auto McpSession::cancel(std::string_view id) -> bool {
+    auto it = mInflight.find(id);
+    if (it == mInflight.end()) {
+        return false;
+    }
+    // A stopped task never reaches its endRequest(), the entry goes with the cancellation. It is taken out first, the
+    // callback may end the request or begin another one.
+    auto request = mInflight.extract(it);
+    request.mapped().cancel();
+    return true;
+}
+
+auto McpSession::cancelAll() -> void {
+    auto inflight = std::move(mInflight);
+    mInflight.clear();
+    for (auto& [_, request] : inflight) {
+        request.cancel();
+    }
+}
+
+auto McpSession::Inflight::cancel() -> void {
+    stop.request_stop();
+    if (onCancel) {
+        onCancel();
+    } else if (handle) {
+        handle.stop();
+    }
+}
+
+auto McpSession::_write_pending() -> IoTask<void> {
+    while (!mPending.empty()) {
+        auto message = std::move(mPending.front());
+        mPending.pop_front();
+        if (auto ret = co_await write(std::as_bytes(std::span(*message))); !ret) {
+            mPending.clear();
+            co_return ILIAS_NAMESPACE::Err(ret.error());
+        }
+    }
+    co_return {};
+}
+
+auto McpSession::_flush_posted(std::shared_ptr<McpSession> self) -> ILIAS_NAMESPACE::Task<void> {
+    if (auto ret = co_await self->_write_pending(); !ret) {
+        NEKO_LOG_WARN("mcp session", "session {} write failed: {}", self->mId, ret.error().message());
+    }
+    self->mWriting = false;
+}
+} // namespace detail
+
+CCMCP_EN
@@ -6,6 +6,7 @@
 #include <minihttp/router.hpp>
 #include <nekoproto/global/log.hpp>
 
+#include <charconv>
 #include <chrono>
 #include <map>
 #include <string>
@@ -37,8 +38,6 @@ auto SseServerStream::recv(std::vector<std::byte>& buffer) -> ilias::IoTask<void
 
     auto ptr = reinterpret_cast<const std::byte*>(in->data());
     buffer.assign(ptr, ptr + in->size());
-    NEKO_LOG_INFO("sse", "received {} bytes: {}", buffer.size(),
-                  std::string_view{reinterpret_cast<const char*>(buffer.data()), buffer.size()});
     co_return {};
 }
 
@@ -89,13 +88,41 @@ struct SseListener::Impl {
     using Router       = minihttp::server::Router;
 
     explicit Impl(ilias::TcpListener listener) : listener(std::move(listener)) {}
+    ~Impl() {
+        if (router) {
+            router->detach(shard);
+        }
+    }
 
     auto close() -> void {
+        if (router) {
+            router->detach(shard);
+        }
         if (handle) {
             handle.stop();
             handle.wait();
             handle = nullptr;
         }
+        streamSender.close();
+    }
+
+    auto makeSessionId(size_t number) const -> std::string {
+        if (!router) {
+            return std::to_string(number);
+        }
+        return std::to_string(shard) + "-" + std::to_string(number);
+    }
+
+    /// Runs on this shard's thread, for messages posted to another shard.
+    auto deliver(std::string sessionId, std::string content) -> ilias::Task<void> {
+        auto it = sessions.find(sessionId);
+        if (it == sessions.end()) {
+            NEKO_LOG_WARN("sse", "Session id '{}' closed before a forwarded message arrived", sessionId);
+            co_return;
+        }
+        if (!co_await it->second.send(std::move(content))) {
+            NEKO_LOG_ERROR("sse", "Failed to send content to session {}", sessionId);
+        }
     }
 
     auto loop() -> ilias::Task<void> {
@@ -130,7 +157,7 @@ struct SseListener::Impl {
         co_await streamSender.send(std::move(stream));
 
         id += 1;
-        sessions.insert({std::to_string(id), std::move(inSender)});
+        sessions.insert({makeSessionId(id), std::move(inSender)});
         co_return Sse(sseGenerator(std::move(outReceiver), id));
     }
 
@@ -142,6 +169,12 @@ struct SseListener::Impl {
             NEKO_LOG_DEBUG("sse", "Content: {}", content);
         }
 
+        if (router) {
+            if (auto owner = SseShardRouter::shardOf(params["id"]); owner != shard) {
+                // The session lives on another event loop, its channel must only be touched from there.
+                co_return Text(router->forward(params["id"], std::move(content)) ? "OK" : "Invalid id");
+            }
+        }
         auto it = sessions.find(params["id"]);
         if (it == sessions.end()) {
             NEKO_LOG_WARN("sse", "Session id '{}' not found. Available sessions: {}", params["id"], sessions.size());
@@ -160,14 +193,14 @@ struct SseListener::Impl {
 
     auto sseGenerator(ilias::mpsc::Receiver<std::string> input, size_t sessionId) -> SseGenerator {
         struct Guard {
-            ~Guard() { self.sessions.erase(std::to_string(sessionId)); }
+            ~Guard() { self.sessions.erase(self.makeSessionId(sessionId)); }
 
             Impl& self;
             size_t sessionId;
         } guard{*this, sessionId};
 
         co_yield SseEvent{
-            .comment = {}, .event = "endpoint", .data = "/message?id=" + std::to_string(sessionId), .retry = {}};
+            .comment = {}, .event = "endpoint", .data = "/message?id=" + makeSessionId(sessionId), .retry = {}};
         while (true) {
             auto [text, timeout] = co_await ilias::whenAny(input.recv(), ilias::sleep(keepAliveInterval));
             if (text && *text) {
@@ -189,9 +222,91 @@ struct SseListener::Impl {
     std::chrono::milliseconds keepAliveInterval{15000};
     std::map<std::string, ilias::mpsc::Sender<std::string>> sessions;
     size_t id = 0;
+    std::shared_ptr<SseShardRouter> router;
+    size_t shard = 0;
 };
 
+auto SseShardRouter::shardOf(std::string_view id) noexcept -> std::size_t {
+    auto dash = id.find('-');
+    if (dash == std::string_view::npos) {
+        return static_cast<std::size_t>(-1);
+    }
+    std::size_t shard = 0;
+    const auto* end = id.data() + dash;
+    if (auto [ptr, ec] = std::from_chars(id.data(), end, shard); ec != std::errc{} || ptr != end) {
+        return static_cast<std::size_t>(-1);
+    }
+    return shard;
+}
+
+auto SseShardRouter::attach(std::size_t shard, ilias::IoContext& context, Deliver deliver) -> void {
+    std::lock_guard lock(mMutex);
+    if (shard < mShards.size()) {
+        auto inbox     = std::make_shared<Inbox>();
+        inbox->context = &context;
+        inbox->deliver = std::move(deliver);
+        mShards[shard] = std::move(inbox);
+    }
+}
+
+auto SseShardRouter::detach(std::size_t shard) -> void {
+    std::lock_guard lock(mMutex);
+    if (shard < mShards.size()) {
+        mShards[shard].reset();
+    }
+}
+
+auto SseShardRouter::forward(std::string_view id, std::string content) -> bool {
+    std::shared_ptr<Inbox> inbox;
+    {
+        std::lock_guard lock(mMutex);
+        const auto shard = shardOf(id);
+        if (shard >= mShards.size() || !mShards[shard]) {
+            return false;
+        }
+        inbox = mShards[shard];
+    }
+    bool post = false;
+    {
+        std::lock_guard lock(inbox->mutex);
+        inbox->messages.emplace_back(std::string(id), std::move(content));
+        post = !std::exchange(inbox->posted, true);
+    }
+    if (post) {
+        inbox->context->post(&SseShardRouter::_drain, new std::weak_ptr<Inbox>(inbox));
+    }
+    return true;
+}
+
+auto SseShardRouter::_drain(void* data) -> void {
+    std::unique_ptr<std::weak_ptr<Inbox>> weak(static_cast<std::weak_ptr<Inbox>*>(data));
+    auto inbox = weak->lock();
+    if (!inbox) {
+        return;
+    }
+    std::deque<std::pair<std::string, std::string>> messages;
+    {
+        std::lock_guard lock(inbox->mutex);
+        messages.swap(inbox->messages);
+        inbox->posted = false;
+    }
+    // Detaching happens on this thread too, the deliver callback cannot outlive its listener while this runs.
+    for (auto& [id, content] : messages) {
+        inbox->deliver(std::move(id), std::move(content));
+    }
+}
+
 SseListener::SseListener(ilias::TcpListener listener) : mImpl(std::make_unique<Impl>(std::move(listener))) {}
+
+SseListener::SseListener(ilias::TcpListener listener, std::shared_ptr<SseShardRouter> router, std::size_t shard,
+                         ilias::IoContext& context)
+    : mImpl(std::make_unique<Impl>(std::move(listener))) {
+    mImpl->router = std::move(router);
+    mImpl->shard  = shard;
+    mImpl->router->attach(shard, context, [impl = mImpl.get()](std::string id, std::string content) {
+        (void)ilias::spawn(impl->deliver(std::move(id), std::move(content)));
+    });
+}
 SseListener::SseListener(SseListener&&) noexcept = default;
 SseListener::~SseListener()                      = default;
 
@@ -38,7 +38,6 @@ auto StdioStream::recv(std::vector<std::byte>& buffer) -> IoTask<void> {
     }
     if (auto ret = co_await (mImpl->in.getline("\n")); ret) {
         std::swap(mImpl->json, ret.value());
-        NEKO_LOG_INFO("DatagramClient", "recv: {}", mImpl->json);
         if (mImpl->json.find('{') == std::string::npos && mImpl->json.find('[') == std::string::npos &&
             mImpl->json.find("exit") != std::string::npos) {
             NEKO_LOG_INFO("DatagramClient", "exit");
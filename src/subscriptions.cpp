@@ -0,0 +1,88 @@
+#include "ccmcp/server/subscriptions.hpp"
+
+#include <algorithm>
+
+CCMCP_BN
+
+namespace detail {
+auto SubscriptionIndex::subscribe(const std::shared_ptr<McpSession>& session, std::string_view uri) -> void {
+    auto& uris = mSessions[session->id()];
+    if (std::find(uris.begin(), uris.end(), uri) != uris.end()) {
+        return;
+    }
+    uris.emplace_back(uri);
+    auto it = mSubscribers.find(uri);
+    if (it == mSubscribers.end()) {
+        it = mSubscribers.emplace(std::string(uri), std::vector<std::weak_ptr<McpSession>>{}).first;
+    }
+    it->second.push_back(session);
+}
+
+auto SubscriptionIndex::unsubscribe(const McpSession& session, std::string_view uri) -> bool {
+    auto it = mSessions.find(session.id());
+    if (it == mSessions.end()) {
+        return false;
+    }
+    auto uri_it = std::find(it->second.begin(), it->second.end(), uri);
+    if (uri_it == it->second.end()) {
+        return false;
+    }
+    it->second.erase(uri_it);
+    if (it->second.empty()) {
+        mSessions.erase(it);
+    }
+    _erase_subscriber(uri, session.id());
+    return true;
+}
+
+auto SubscriptionIndex::removeSession(const McpSession& session) -> std::size_t {
+    auto it = mSessions.find(session.id());
+    if (it == mSessions.end()) {
+        return 0;
+    }
+    const auto uris = std::move(it->second);
+    mSessions.erase(it);
+    for (const auto& uri : uris) {
+        _erase_subscriber(uri, session.id());
+    }
+    return uris.size();
+}
+
+auto SubscriptionIndex::publish(std::string_view uri, const std::shared_ptr<const std::string>& message)
+    -> std::size_t {
+    auto it = mSubscribers.find(uri);
+    if (it == mSubscribers.end()) {
+        return 0;
+    }
+    std::size_t count = 0;
+    std::erase_if(it->second, [&](const std::weak_ptr<McpSession>& subscriber) {
+        auto session = subscriber.lock();
+        if (!session || session->isClosed()) {
+            return true;
+        }
+        session->post(message);
+        ++count;
+        return false;
+    });
+    if (it->second.empty()) {
+        mSubscribers.erase(it);
+    }
+    return count;
+}
+
+auto SubscriptionIndex::_erase_subscriber(std::string_view uri, uint64_t session) -> void {
+    auto it = mSubscribers.find(uri);
+    if (it == mSubscribers.end()) {
+        return;
+    }
+    std::erase_if(it->second, [&](const std::weak_ptr<McpSession>& subscriber) {
+        auto ptr = subscriber.lock();
+        return !ptr || ptr->id() == session;
+    });
+    if (it->second.empty()) {
+        mSubscribers.erase(it);
+    }
+}
+} // namespace detail
+
+CCMCP_EN
@@ -0,0 +1,92 @@
+#include "ccmcp/server/tool_catalog.hpp"
+
+#include "ccmcp/model/raw_message.hpp"
+#include "ccmcp/server/pagination.hpp"
+
+#include <algorithm>
+
+CCMCP_BN
+
+namespace {
+auto assemble_page(const std::vector<std::string>& toolJson, std::size_t begin, std::size_t end,
+                   const std::optional<std::string>& nextCursor) -> std::string {
+    std::size_t size = 32;
+    for (auto idx = begin; idx < end; ++idx) {
+        size += toolJson[idx].size() + 1;
+    }
+    std::string json;
+    json.reserve(size + (nextCursor ? nextCursor->size() + 16 : 0));
+    json.append(R"({"tools":[)");
+    for (auto idx = begin; idx < end; ++idx) {
+        if (idx != begin) {
+            json.push_back(',');
+        }
+        json.append(toolJson[idx]);
+    }
+    json.push_back(']');
+    if (nextCursor) {
+        json.append(R"(,"nextCursor":)");
+        detail::json_append_string(json, *nextCursor);
+    }
+    json.push_back('}');
+    return json;
+}
+} // namespace
+
+namespace detail {
+auto ToolCatalog::Snapshot::page(const std::optional<std::string>& after, std::size_t limit) const
+    -> std::pair<std::size_t, std::size_t> {
+    const auto& tools = result.tools;
+    std::size_t begin = 0;
+    if (after) {
+        begin = std::upper_bound(tools.begin(), tools.end(), *after,
+                                 [](const std::string& key, const Tool& tool) { return key < tool.name; }) -
+                tools.begin();
+    }
+    const std::size_t end = limit == 0 ? tools.size() : std::min(tools.size(), begin + limit);
+    return {begin, end};
+}
+
+auto ToolCatalog::Snapshot::pageResult(const std::optional<std::string>& after, std::size_t limit) const
+    -> ToolsListResult {
+    auto [begin, end] = page(after, limit);
+    ToolsListResult pageResult;
+    pageResult.tools.assign(result.tools.begin() + begin, result.tools.begin() + end);
+    if (end < result.tools.size() && end > begin) {
+        pageResult.nextCursor = encode_cursor("tools", result.tools[end - 1].name);
+    }
+    return pageResult;
+}
+
+auto ToolCatalog::Snapshot::pageJson(const std::optional<std::string>& after, std::size_t limit) const
+    -> std::string {
+    auto [begin, end] = page(after, limit);
+    if (begin == 0 && end == result.tools.size()) {
+        return json;
+    }
+    std::optional<std::string> nextCursor;
+    if (end < result.tools.size() && end > begin) {
+        nextCursor = encode_cursor("tools", result.tools[end - 1].name);
+    }
+    return assemble_page(toolJson, begin, end, nextCursor);
+}
+
+auto ToolCatalog::update(ToolsListResult result, uint64_t registryVersion) -> std::shared_ptr<const Snapshot> {
+    std::stable_sort(result.tools.begin(), result.tools.end(),
+                     [](const Tool& lhs, const Tool& rhs) { return lhs.name < rhs.name; });
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->toolJson.reserve(result.tools.size());
+    for (const auto& tool : result.tools) {
+        snapshot->toolJson.push_back(serialize_json(tool));
+    }
+    snapshot->json    = assemble_page(snapshot->toolJson, 0, snapshot->toolJson.size(), std::nullopt);
+    snapshot->result  = std::move(result);
+    snapshot->version = ++mVersion;
+    mSnapshot         = std::move(snapshot);
+    mRegistryVersion  = registryVersion;
+    mDirty            = false;
+    return mSnapshot;
+}
+} // namespace detail
+
+CCMCP_EN
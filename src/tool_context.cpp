@@ -0,0 +1,24 @@
+#include "ccmcp/server/tool_context.hpp"
+
+#include <utility>
+
+CCMCP_BN
+
+namespace {
+thread_local std::stop_token current_stop_token;
+} // namespace
+
+namespace detail {
+StopTokenScope::StopTokenScope(std::stop_token stop) noexcept
+    : mPrevious(std::exchange(current_stop_token, std::move(stop))) {}
+
+StopTokenScope::~StopTokenScope() { current_stop_token = std::move(mPrevious); }
+} // namespace detail
+
+namespace this_tool {
+auto stop_token() noexcept -> std::stop_token { return current_stop_token; }
+
+auto stop_requested() noexcept -> bool { return current_stop_token.stop_requested(); }
+} // namespace this_tool
+
+CCMCP_EN
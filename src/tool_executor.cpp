@@ -0,0 +1,48 @@
+#include "ccmcp/server/tool_executor.hpp"
+
+CCMCP_BN
+
+ToolExecutor::ToolExecutor(std::size_t threads) {
+    threads = threads == 0 ? 1 : threads;
+    mThreads.reserve(threads);
+    for (std::size_t idx = 0; idx < threads; ++idx) {
+        mThreads.emplace_back([this]() { _worker(); });
+    }
+}
+
+ToolExecutor::~ToolExecutor() {
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+    for (auto& thread : mThreads) {
+        thread.join();
+    }
+}
+
+auto ToolExecutor::post(std::function<void()> job) -> void {
+    {
+        std::lock_guard lock(mMutex);
+        mJobs.push_back(std::move(job));
+    }
+    mCondition.notify_one();
+}
+
+auto ToolExecutor::_worker() -> void {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(mMutex);
+            mCondition.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+            if (mJobs.empty()) {
+                return;
+            }
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+        }
+        job();
+    }
+}
+
+CCMCP_EN
@@ -0,0 +1,92 @@
+#include "ccmcp/server/tool_limiter.hpp"
+
+#include <algorithm>
+
+CCMCP_BN
+
+namespace detail {
+ToolLimiter::AcquireAwaiter::~AcquireAwaiter() {
+    mCanceler.reset();
+    if (mQueued) {
+        // The frame is destroyed while waiting, wake() must not resume it.
+        std::erase(mLimiter.mWaiters, this);
+    } else if (mGranted) {
+        mLimiter._release(mContext, mMaxConcurrency);
+    }
+}
+
+auto ToolLimiter::AcquireAwaiter::await_ready() noexcept -> bool {
+    if (mStop.stop_requested()) {
+        mAdmission.reset();
+        return true;
+    }
+    if (mMaxConcurrency != 0 && (mLimiter.mRunning >= mMaxConcurrency || !mLimiter.mWaiters.empty())) {
+        return false;
+    }
+    _grant();
+    return true;
+}
+
+auto ToolLimiter::AcquireAwaiter::await_suspend(std::coroutine_handle<> handle) -> void {
+    mHandle = handle;
+    mQueued = true;
+    mLimiter.mWaiters.push_back(this);
+    // The stop is requested on the IoContext thread, it cannot come between await_ready() and here.
+    mCanceler.emplace(mStop, Canceler{this});
+}
+
+auto ToolLimiter::AcquireAwaiter::await_resume() noexcept -> ILIAS_NAMESPACE::IoResult<Permit> {
+    mCanceler.reset();
+    if (!std::exchange(mGranted, false)) {
+        return ILIAS_NAMESPACE::Err(ILIAS_NAMESPACE::IoError::Canceled);
+    }
+    return Permit(mLimiter, mContext, mMaxConcurrency);
+}
+
+auto ToolLimiter::AcquireAwaiter::_grant() noexcept -> void {
+    // The reserved place is now counted by the running slot.
+    mAdmission.mLimiter = nullptr;
+    mGranted            = true;
+    ++mLimiter.mRunning;
+}
+
+auto ToolLimiter::AcquireAwaiter::_cancel() noexcept -> void {
+    if (!mQueued) {
+        // Already handed a slot, the call starts and sees the stop itself.
+        return;
+    }
+    mQueued = false;
+    std::erase(mLimiter.mWaiters, this);
+    mAdmission.reset();
+    // The stop may be requested from inside another coroutine.
+    mContext.post(&ToolLimiter::_resume, mHandle.address());
+}
+
+auto ToolLimiter::tryAdmit(std::size_t maxConcurrency, std::size_t maxQueue) noexcept -> Admission {
+    if (maxConcurrency != 0 && mAdmitted >= maxConcurrency + maxQueue) {
+        return {};
+    }
+    ++mAdmitted;
+    return Admission(*this);
+}
+
+auto ToolLimiter::_release(ILIAS_NAMESPACE::IoContext& context, std::size_t maxConcurrency) -> void {
+    --mAdmitted;
+    --mRunning;
+    wake(context, maxConcurrency);
+}
+
+auto ToolLimiter::wake(ILIAS_NAMESPACE::IoContext& context, std::size_t maxConcurrency) -> void {
+    while (!mWaiters.empty() && (maxConcurrency == 0 || mRunning < maxConcurrency)) {
+        // The slot is handed over here, the waiter does not run await_ready() again.
+        auto* waiter = mWaiters.front();
+        mWaiters.pop_front();
+        waiter->mQueued = false;
+        waiter->_grant();
+        // Resume from the event loop, a chain of tools finishing right away would otherwise nest on this stack.
+        context.post(&ToolLimiter::_resume, waiter->mHandle.address());
+    }
+}
+} // namespace detail
+
+CCMCP_EN
@@ -0,0 +1,302 @@
+#include "ccmcp/server/uri_template.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <utility>
+
+CCMCP_BN
+
+namespace {
+struct TemplateSegment {
+    enum class Kind { Literal, Capture, Affix, Tail };
+
+    Kind kind = Kind::Literal;
+    std::string_view literal; // the whole segment, or the prefix of an affix capture
+    std::string_view suffix;
+    std::string_view name;
+    bool integer = false;
+};
+
+auto valid_name(std::string_view name) noexcept -> bool {
+    if (name.empty()) {
+        return false;
+    }
+    for (unsigned char c : name) {
+        if (!std::isalnum(c) && c != '_' && c != '.') {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto parse_segment(std::string_view segment, bool last) -> std::optional<TemplateSegment> {
+    const auto open = segment.find('{');
+    if (open == std::string_view::npos) {
+        if (segment.find('}') != std::string_view::npos) {
+            return std::nullopt;
+        }
+        return TemplateSegment{
+            .kind = TemplateSegment::Kind::Literal, .literal = segment, .suffix = {}, .name = {}, .integer = false};
+    }
+    const auto close = segment.find('}', open);
+    if (close == std::string_view::npos || segment.find('}') < open ||
+        segment.find_first_of("{}", close + 1) != std::string_view::npos) {
+        return std::nullopt;
+    }
+    auto expression = segment.substr(open + 1, close - open - 1);
+    const bool tail = expression.starts_with('+');
+    if (tail) {
+        expression.remove_prefix(1);
+    }
+    bool integer = false;
+    if (const auto colon = expression.find(':'); colon != std::string_view::npos) {
+        if (tail || expression.substr(colon + 1) != "int") {
+            return std::nullopt;
+        }
+        integer    = true;
+        expression = expression.substr(0, colon);
+    }
+    if (!valid_name(expression)) {
+        return std::nullopt;
+    }
+    TemplateSegment parsed{.kind    = TemplateSegment::Kind::Capture,
+                           .literal = segment.substr(0, open),
+                           .suffix  = segment.substr(close + 1),
+                           .name    = expression,
+                           .integer = integer};
+    if (tail) {
+        if (!last || !parsed.literal.empty() || !parsed.suffix.empty()) {
+            return std::nullopt;
+        }
+        parsed.kind = TemplateSegment::Kind::Tail;
+    } else {
+        parsed.kind = parsed.literal.empty() && parsed.suffix.empty() ? TemplateSegment::Kind::Capture
+                                                                      : TemplateSegment::Kind::Affix;
+    }
+    return parsed;
+}
+
+auto split_segments(std::string_view text) -> std::vector<std::string_view> {
+    std::vector<std::string_view> segments;
+    std::size_t pos = 0;
+    while (true) {
+        const auto end = text.find('/', pos);
+        segments.push_back(text.substr(pos, end == std::string_view::npos ? end : end - pos));
+        if (end == std::string_view::npos) {
+            return segments;
+        }
+        pos = end + 1;
+    }
+}
+
+auto is_integer(std::string_view text) noexcept -> bool {
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+auto hex_value(char c) noexcept -> int {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+} // namespace
+
+namespace detail {
+auto UriTemplateMatcher::insert(std::string_view uriTemplate, std::size_t value) -> bool {
+    const auto segments = split_segments(uriTemplate);
+    std::vector<TemplateSegment> parsed;
+    parsed.reserve(segments.size());
+    for (std::size_t idx = 0; idx < segments.size(); ++idx) {
+        auto segment = parse_segment(segments[idx], idx + 1 == segments.size());
+        if (!segment) {
+            return false;
+        }
+        parsed.push_back(*segment);
+    }
+    uint32_t node = 0;
+    std::vector<std::string> names;
+    for (const auto& segment : parsed) {
+        switch (segment.kind) {
+        case TemplateSegment::Kind::Literal:
+            if (auto it = mNodes[node].literals.find(segment.literal); it != mNodes[node].literals.end()) {
+                node = it->second;
+            } else {
+                const auto child = _add_node();
+                mNodes[node].literals.emplace(std::string(segment.literal), child);
+                node = child;
+            }
+            break;
+        case TemplateSegment::Kind::Capture: {
+            auto child = segment.integer ? mNodes[node].integer : mNodes[node].capture;
+            if (!child) {
+                child = _add_node();
+                (segment.integer ? mNodes[node].integer : mNodes[node].capture) = child;
+            }
+            node = *child;
+            names.emplace_back(segment.name);
+            break;
+        }
+        case TemplateSegment::Kind::Affix:
+            node = _add_affix(node, segment.literal, segment.suffix, segment.integer);
+            names.emplace_back(segment.name);
+            break;
+        case TemplateSegment::Kind::Tail:
+            if (mNodes[node].tail) {
+                return false;
+            }
+            names.emplace_back(segment.name);
+            mNodes[node].tail = Terminal{.value = value, .names = std::move(names)};
+            ++mSize;
+            return true;
+        }
+    }
+    if (mNodes[node].terminal) {
+        return false;
+    }
+    mNodes[node].terminal = Terminal{.value = value, .names = std::move(names)};
+    ++mSize;
+    return true;
+}
+
+auto UriTemplateMatcher::match(std::string_view uri) const -> std::optional<Match> {
+    std::vector<std::string_view> captures;
+    const auto* terminal = _match(0, uri, 0, captures);
+    if (terminal == nullptr) {
+        return std::nullopt;
+    }
+    Match result{.value = terminal->value, .variables = {}};
+    for (std::size_t idx = 0; idx < captures.size() && idx < terminal->names.size(); ++idx) {
+        result.variables.insert_or_assign(terminal->names[idx], percent_decode(captures[idx]));
+    }
+    return result;
+}
+
+auto UriTemplateMatcher::_add_node() -> uint32_t {
+    mNodes.emplace_back();
+    return static_cast<uint32_t>(mNodes.size() - 1);
+}
+
+auto UriTemplateMatcher::_add_affix(uint32_t node, std::string_view prefix, std::string_view suffix, bool integer)
+    -> uint32_t {
+    if (auto it = mNodes[node].affixes.find(prefix); it != mNodes[node].affixes.end()) {
+        for (const auto& affix : it->second) {
+            if (affix.suffix == suffix && affix.integer == integer) {
+                return affix.node;
+            }
+        }
+    }
+    const auto child = _add_node();
+    auto& parent     = mNodes[node];
+    auto& lengths    = parent.prefixLengths;
+    if (std::find(lengths.begin(), lengths.end(), prefix.size()) == lengths.end()) {
+        const auto at = std::upper_bound(lengths.begin(), lengths.end(), prefix.size(), std::greater<>());
+        lengths.insert(at, prefix.size());
+    }
+    // The longest suffix first, then an int capture before any text.
+    auto& bucket  = parent.affixes[std::string(prefix)];
+    auto position = std::find_if(bucket.begin(), bucket.end(), [&](const Affix& affix) {
+        return affix.suffix.size() < suffix.size() || (affix.suffix.size() == suffix.size() && !affix.integer);
+    });
+    bucket.insert(position, Affix{.suffix = std::string(suffix), .integer = integer, .node = child});
+    return child;
+}
+
+auto UriTemplateMatcher::_match(uint32_t index, std::string_view uri, std::size_t pos,
+                                std::vector<std::string_view>& captures) const -> const Terminal* {
+    const auto& node   = mNodes[index];
+    const auto end     = uri.find('/', pos);
+    const bool last    = end == std::string_view::npos;
+    const auto segment = uri.substr(pos, last ? std::string_view::npos : end - pos);
+    auto descend       = [&](uint32_t child) -> const Terminal* {
+        if (last) {
+            return mNodes[child].terminal ? &*mNodes[child].terminal : nullptr;
+        }
+        return _match(child, uri, end + 1, captures);
+    };
+    if (auto it = node.literals.find(segment); it != node.literals.end()) {
+        if (const auto* terminal = descend(it->second); terminal) {
+            return terminal;
+        }
+    }
+    // One lookup per distinct prefix length, whatever the number of affixes.
+    for (const auto length : node.prefixLengths) {
+        if (length >= segment.size()) {
+            continue;
+        }
+        const auto bucket = node.affixes.find(segment.substr(0, length));
+        if (bucket == node.affixes.end()) {
+            continue;
+        }
+        for (const auto& affix : bucket->second) {
+            if (segment.size() <= length + affix.suffix.size() || !segment.ends_with(affix.suffix)) {
+                continue;
+            }
+            const auto value = segment.substr(length, segment.size() - length - affix.suffix.size());
+            if (affix.integer && !is_integer(value)) {
+                continue;
+            }
+            captures.push_back(value);
+            if (const auto* terminal = descend(affix.node); terminal) {
+                return terminal;
+            }
+            captures.pop_back();
+        }
+    }
+    for (const auto& [child, integer] : {std::pair{node.integer, true}, std::pair{node.capture, false}}) {
+        if (!child || segment.empty() || (integer && !is_integer(segment))) {
+            continue;
+        }
+        captures.push_back(segment);
+        if (const auto* terminal = descend(*child); terminal) {
+            return terminal;
+        }
+        captures.pop_back();
+    }
+    if (node.tail && pos < uri.size()) {
+        captures.push_back(uri.substr(pos));
+        return &*node.tail;
+    }
+    return nullptr;
+}
+
+auto percent_decode(std::string_view text) -> std::string {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (std::size_t idx = 0; idx < text.size(); ++idx) {
+        if (text[idx] == '%' && idx + 2 < text.size()) {
+            const int high = hex_value(text[idx + 1]);
+            const int low  = hex_value(text[idx + 2]);
+            if (high >= 0 && low >= 0) {
+                decoded.push_back(static_cast<char>((high << 4) | low));
+                idx += 2;
+                continue;
+            }
+        }
+        decoded.push_back(text[idx]);
+    }
+    return decoded;
+}
+
+auto append_percent_encoded(std::string& out, std::string_view text, std::string_view keep) -> void {
+    constexpr std::string_view kHex = "0123456789ABCDEF";
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~' ||
+            keep.find(static_cast<char>(c)) != std::string_view::npos) {
+            out.push_back(static_cast<char>(c));
+        } else {
+            out.push_back('%');
+            out.push_back(kHex[c >> 4]);
+            out.push_back(kHex[c & 0x0F]);
+        }
+    }
+}
+} // namespace detail
+
+CCMCP_EN
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdio>
+
+/// Failed checks of the running test binary, main() returns non zero if there is any.
+inline auto check_failures() -> int& {
+    static int failures = 0;
+    return failures;
+}
+
+/// Report `expr` if it does not hold and keep going, so one run lists every failure.
+#define CHECK(...)                                                                                                     \
+    do {                                                                                                               \
+        if (!(__VA_ARGS__)) {                                                                                          \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #__VA_ARGS__);                       \
+            ++check_failures();                                                                                        \
+        }                                                                                                              \
+    } while (0)
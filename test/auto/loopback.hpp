@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <ilias/sync/event.hpp>
+#include <ilias/task.hpp>
+
+/// In memory transport, requests are pushed by the test and responses collected back.
+struct Loopback {
+    std::deque<std::string> incoming;
+    std::vector<std::string> responses;
+    ILIAS_NAMESPACE::Event incomingEvent;
+    ILIAS_NAMESPACE::Event responseEvent;
+    bool closed = false;
+};
+
+class LoopbackStream {
+public:
+    template <typename T>
+    using IoTask = ILIAS_NAMESPACE::IoTask<T>;
+
+    explicit LoopbackStream(std::shared_ptr<Loopback> loopback) : mLoopback(std::move(loopback)) {}
+
+    auto recv(std::vector<std::byte>& buffer) -> IoTask<void> {
+        while (mLoopback->incoming.empty()) {
+            if (mLoopback->closed) {
+                co_return ILIAS_NAMESPACE::Err(ILIAS_NAMESPACE::IoError::Canceled);
+            }
+            mLoopback->incomingEvent.clear();
+            co_await mLoopback->incomingEvent;
+        }
+        auto message = std::move(mLoopback->incoming.front());
+        mLoopback->incoming.pop_front();
+        buffer.resize(message.size());
+        std::memcpy(buffer.data(), message.data(), message.size());
+        co_return {};
+    }
+    auto send(std::span<const std::byte> data) -> IoTask<void> {
+        mLoopback->responses.emplace_back(reinterpret_cast<const char*>(data.data()), data.size());
+        mLoopback->responseEvent.set();
+        co_return {};
+    }
+    auto close() -> void {
+        mLoopback->closed = true;
+        mLoopback->incomingEvent.set();
+    }
+    auto start() -> IoTask<void> { co_return {}; }
+    auto shutdown() -> IoTask<void> { co_return {}; }
+    auto flush() -> IoTask<void> { co_return {}; }
+
+private:
+    std::shared_ptr<Loopback> mLoopback;
+};
+
+inline auto push(Loopback& loopback, std::string request) -> void {
+    loopback.incoming.push_back(std::move(request));
+    loopback.incomingEvent.set();
+}
+
+/// The client side goes away, the server sees the end of the stream.
+inline auto disconnect(Loopback& loopback) -> void {
+    loopback.closed = true;
+    loopback.incomingEvent.set();
+}
+
+inline auto wait_responses(Loopback& loopback, std::size_t count) -> ILIAS_NAMESPACE::Task<void> {
+    while (loopback.responses.size() < count) {
+        loopback.responseEvent.clear();
+        co_await loopback.responseEvent;
+    }
+}
+
+/// Let the server handle what was pushed, for checks on something that is not answered.
+inline auto settle() -> ILIAS_NAMESPACE::Task<void> {
+    (void)co_await ILIAS_NAMESPACE::sleep(std::chrono::milliseconds(20));
+}
@@ -0,0 +1,136 @@
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "ccmcp/server/base64.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+/// byte i is (i * 53 + 7) & 0xFF, every 6-bit value shows up, '+' and '/' included
+auto input() -> std::array<std::byte, 64> {
+    std::array<std::byte, 64> data{};
+    for (std::size_t idx = 0; idx < data.size(); ++idx) {
+        data[idx] = static_cast<std::byte>((idx * 53 + 7) & 0xFF);
+    }
+    return data;
+}
+
+/// base64 of the first n bytes of input(), for every n from 0 to 64
+constexpr std::array<std::string_view, 65> kEncoded = {
+        "",
+        "Bw==",
+        "Bzw=",
+        "Bzxx",
+        "Bzxxpg==",
+        "Bzxxpts=",
+        "BzxxptsQ",
+        "BzxxptsQRQ==",
+        "BzxxptsQRXo=",
+        "BzxxptsQRXqv",
+        "BzxxptsQRXqv5A==",
+        "BzxxptsQRXqv5Bk=",
+        "BzxxptsQRXqv5BlO",
+        "BzxxptsQRXqv5BlOgw==",
+        "BzxxptsQRXqv5BlOg7g=",
+        "BzxxptsQRXqv5BlOg7jt",
+        "BzxxptsQRXqv5BlOg7jtIg==",
+        "BzxxptsQRXqv5BlOg7jtIlc=",
+        "BzxxptsQRXqv5BlOg7jtIleM",
+        "BzxxptsQRXqv5BlOg7jtIleMwQ==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfY=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYr",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYA==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJU=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/w==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zQ=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRp",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpng==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntM=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMI",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPQ==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXI=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3A==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BE=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFG",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGew==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7A=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7Dl",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGg==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk8=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+E",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+EuQ==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4j",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWA==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI0=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9w==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yw=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxh",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlg==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlss=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssA",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANQ==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANWo=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANWqf",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANWqf1A==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANWqf1Ak=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANWqf1Ak+",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANWqf1Ak+cw==",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANWqf1Ak+c6g=",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANWqf1Ak+c6jd",
+        "BzxxptsQRXqv5BlOg7jtIleMwfYrYJXK/zRpntMIPXKn3BFGe7DlGk+Eue4jWI3C9yxhlssANWqf1Ak+c6jdEg==",
+};
+
+auto encode(void (*encoder)(std::span<const std::byte>, char*) noexcept, std::span<const std::byte> data)
+    -> std::string {
+    std::string out(detail::base64_encoded_size(data.size()), '\0');
+    encoder(data, out.data());
+    return out;
+}
+
+auto test_lengths() -> void {
+    const auto data = input();
+    // Every length crosses the SIMD block sizes and ends on each of the three padding cases.
+    for (std::size_t size = 0; size <= data.size(); ++size) {
+        const auto prefix = std::span<const std::byte>(data).first(size);
+        CHECK(encode(&detail::base64_encode, prefix) == kEncoded[size]);
+        CHECK(encode(&detail::base64_encode_scalar, prefix) == kEncoded[size]);
+        std::string appended = "x";
+        detail::base64_append(appended, prefix);
+        CHECK(appended == "x" + std::string(kEncoded[size]));
+    }
+}
+
+auto test_rfc4648() -> void {
+    const std::array<std::pair<std::string_view, std::string_view>, 7> vectors = {{
+        {"", ""},
+        {"f", "Zg=="},
+        {"fo", "Zm8="},
+        {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="},
+        {"fooba", "Zm9vYmE="},
+        {"foobar", "Zm9vYmFy"},
+    }};
+    for (const auto& [text, encoded] : vectors) {
+        const auto bytes = std::as_bytes(std::span(text.data(), text.size()));
+        CHECK(encode(&detail::base64_encode, bytes) == encoded);
+        CHECK(encode(&detail::base64_encode_scalar, bytes) == encoded);
+    }
+}
+} // namespace
+
+int main() {
+    test_lengths();
+    test_rfc4648();
+    std::cout << "base64: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
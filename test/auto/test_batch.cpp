@@ -0,0 +1,82 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <ilias/platform.hpp>
+#include <ilias/task.hpp>
+
+#include "ccmcp/server/server.hpp"
+
+#include "check.hpp"
+#include "loopback.hpp"
+
+CCMCP_USE_NAMESPACE
+
+struct WaitParams {
+    int ms = 0;
+
+    NEKO_SERIALIZER(ms)
+};
+
+namespace {
+auto wait_call(int id, int ms) -> std::string {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) +
+           R"(,"method":"tools/call","params":{"name":"wait","arguments":{"ms":)" + std::to_string(ms) + "}}}";
+}
+
+auto cancel(int id) -> std::string {
+    return R"({"jsonrpc":"2.0","method":"notifications/cancelled","params":{"requestId":)" + std::to_string(id) + "}}";
+}
+} // namespace
+
+int ilias_main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+    ILIAS_NAMESPACE::PlatformContext platform;
+    McpServer<void> server(platform);
+    server.setCapabilities(ToolsCapability{});
+    server.registerToolFunction("wait", std::function([](WaitParams params) -> ILIAS_NAMESPACE::IoTask<int> {
+                                    co_await ILIAS_NAMESPACE::sleep(std::chrono::milliseconds(params.ms));
+                                    co_return params.ms;
+                                }));
+    auto loopback = std::make_shared<Loopback>();
+    server.addTransport(LoopbackStream(loopback));
+
+    // The elements finish in reverse order, the reply still follows the request.
+    push(*loopback, "[" + wait_call(1, 120) + "," + cancel(100) + "," + wait_call(2, 60) + "," + wait_call(3, 1) +
+                        R"(,{"jsonrpc":"2.0","id":4,"method":"tools/list"}])");
+    co_await wait_responses(*loopback, 1);
+    co_await settle();
+    CHECK(loopback->responses.size() == 1);
+    const auto& reply = loopback->responses.front();
+    const auto first  = reply.find(R"("id":1,)");
+    const auto second = reply.find(R"("id":2,)");
+    const auto third  = reply.find(R"("id":3,)");
+    const auto fourth = reply.find(R"("id":4,)");
+    CHECK(!reply.empty() && reply.front() == '[' && reply.back() == ']');
+    CHECK(first != std::string::npos && first < second && second < third && third < fourth);
+    CHECK(fourth != std::string::npos);
+    // The notification has no entry in the reply.
+    std::size_t entries = 0;
+    for (auto pos = reply.find(R"("jsonrpc")"); pos != std::string::npos; pos = reply.find(R"("jsonrpc")", pos + 1)) {
+        ++entries;
+    }
+    CHECK(entries == 4);
+
+    // Nothing is sent back for notifications, alone or in a batch.
+    push(*loopback, cancel(101));
+    push(*loopback, "[" + cancel(102) + "," + cancel(103) + "]");
+    co_await settle();
+    CHECK(loopback->responses.size() == 1);
+
+    // A call cancelled by a later batch leaves no entry either.
+    push(*loopback, "[" + wait_call(5, 400) + "," + wait_call(6, 1) + "]");
+    co_await settle();
+    push(*loopback, cancel(5));
+    co_await wait_responses(*loopback, 2);
+    CHECK(loopback->responses.back().find(R"("id":6,)") != std::string::npos);
+    CHECK(loopback->responses.back().find(R"("id":5,)") == std::string::npos);
+
+    server.close();
+    std::cout << "batch: " << check_failures() << " failures" << std::endl;
+    co_return check_failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+
+#include "ccmcp/server/file_resource.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+auto range_of(std::string_view uri) -> std::optional<detail::ByteRange> { return detail::split_byte_range(uri).second; }
+
+auto test_split() -> void {
+    auto [uri, range] = detail::split_byte_range("file:///a.log#bytes=10-19");
+    CHECK(uri == "file:///a.log");
+    CHECK(range && range->offset == 10 && range->length == 10u && !range->fromEnd);
+
+    range = range_of("file:///a.log#bytes=10-");
+    CHECK(range && range->offset == 10 && !range->length && !range->fromEnd);
+    range = range_of("file:///a.log#bytes=-100");
+    CHECK(range && range->fromEnd && range->length == 100u);
+    range = range_of("file:///a.log#bytes=0-0");
+    CHECK(range && range->offset == 0 && range->length == 1u);
+    // The range covering every offset has no length.
+    range = range_of("file:///a.log#bytes=0-18446744073709551615");
+    CHECK(range && !range->length);
+
+    // Malformed suffixes are part of the URI.
+    for (std::string_view bad : {"file:///a.log", "file:///a.log#bytes=", "file:///a.log#bytes=5",
+                                 "file:///a.log#bytes=9-3", "file:///a.log#bytes=x-3", "file:///a.log#bytes=1-2x",
+                                 "file:///a.log#bytes=-"}) {
+        auto [same, none] = detail::split_byte_range(bad);
+        CHECK(same == bad);
+        CHECK(!none);
+    }
+    // Only the last marker counts.
+    std::tie(uri, range) = detail::split_byte_range("file:///x#bytes=1-2.txt#bytes=3-4");
+    CHECK(uri == "file:///x#bytes=1-2.txt" && range && range->offset == 3);
+}
+
+auto test_resolve() -> void {
+    using Pair = std::pair<std::uintmax_t, std::uintmax_t>;
+    CHECK((detail::ByteRange{.offset = 10, .length = 5}.resolve(100, 1000) == Pair{10, 5}));
+    CHECK((detail::ByteRange{.offset = 10, .length = std::nullopt}.resolve(100, 1000) == Pair{10, 90}));
+    CHECK((detail::ByteRange{.offset = 95, .length = 50}.resolve(100, 1000) == Pair{95, 5}));
+    CHECK((detail::ByteRange{.offset = 200, .length = 5}.resolve(100, 1000) == Pair{100, 0}));
+    CHECK((detail::ByteRange{.length = 30, .fromEnd = true}.resolve(100, 1000) == Pair{70, 30}));
+    CHECK((detail::ByteRange{.length = 300, .fromEnd = true}.resolve(100, 1000) == Pair{0, 100}));
+    // maxLength cuts the range, not its start.
+    CHECK((detail::ByteRange{.offset = 10, .length = std::nullopt}.resolve(100, 20) == Pair{10, 20}));
+    CHECK((detail::ByteRange{.length = 50, .fromEnd = true}.resolve(100, 20) == Pair{50, 20}));
+}
+
+auto read_range(const detail::LocalFileResource& file, std::string_view uri) -> std::string {
+    std::string out;
+    detail::append_file_range_result(out, file, uri, *range_of(uri));
+    return out;
+}
+
+auto test_utf8_slice() -> void {
+    const auto path = std::filesystem::temp_directory_path() / "ccmcp_test_byte_range.txt";
+    {
+        // a, a three byte sequence, b
+        std::ofstream stream(path, std::ios::binary);
+        stream << "a\xE6\xBC\xA2" "b";
+    }
+    const detail::LocalFileResource text{.path = path, .mimeType = "text/plain"};
+
+    // A range ending inside the sequence finishes it.
+    auto out = read_range(text, "file:///t#bytes=0-1");
+    CHECK(out.find("\"text\":\"a\xE6\xBC\xA2\"") != std::string::npos);
+    CHECK(out.find(R"("_meta":{"offset":0,"length":4,"totalSize":5,"nextOffset":4})") != std::string::npos);
+    // The next range starts inside it and skips what the previous chunk already sent.
+    out = read_range(text, "file:///t#bytes=2-4");
+    CHECK(out.find(R"("text":"b")") != std::string::npos);
+    CHECK(out.find(R"("_meta":{"offset":4,"length":1,"totalSize":5})") != std::string::npos);
+    out = read_range(text, "file:///t#bytes=-1");
+    CHECK(out.find(R"("text":"b")") != std::string::npos);
+
+    // Binary files are cut exactly.
+    const detail::LocalFileResource binary{.path = path, .mimeType = "application/octet-stream"};
+    out = read_range(binary, "file:///t#bytes=0-1");
+    CHECK(out.find(R"("blob":"YeY=")") != std::string::npos);
+    CHECK(out.find(R"("offset":0,"length":2,)") != std::string::npos);
+
+    std::filesystem::remove(path);
+}
+
+auto test_read_copy() -> void {
+    const auto path  = std::filesystem::temp_directory_path() / "ccmcp_test_byte_range.bin";
+    const auto write = [&](std::string_view content) {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << content;
+    };
+    write("0123456789");
+    std::error_code ec;
+    // A file read into memory can be truncated under it, a mapping would raise SIGBUS on the next access.
+    auto copy = detail::MappedFile::open(path, ec);
+    CHECK(!ec && copy.view() == "0123456789");
+    std::filesystem::resize_file(path, 0);
+    CHECK(copy.view() == "0123456789");
+    auto range = detail::MappedFile::open(path, ec, detail::ByteRange{.offset = 5, .length = 5}, 100);
+    CHECK(!ec && range.size() == 0 && range.fileSize() == 0);
+
+    write("0123456789");
+    auto mapped = detail::MappedFile::open(path, ec, detail::ByteRange{.offset = 2, .length = 3}, 100, 2, true);
+    CHECK(!ec && mapped.view() == "234" && mapped.lookahead() == "56" && mapped.fileSize() == 10);
+    range = detail::MappedFile::open(path, ec, detail::ByteRange{.offset = 2, .length = 3}, 100, 2);
+    CHECK(!ec && range.view() == "234" && range.lookahead() == "56" && range.offset() == 2);
+    std::filesystem::remove(path);
+}
+} // namespace
+
+int main() {
+    test_split();
+    test_resolve();
+    test_utf8_slice();
+    test_read_copy();
+    std::cout << "byte range: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <ilias/platform.hpp>
+#include <ilias/task.hpp>
+
+#include "ccmcp/server/server.hpp"
+
+#include "check.hpp"
+#include "loopback.hpp"
+
+CCMCP_USE_NAMESPACE
+
+struct WaitParams {
+    int ms = 0;
+
+    NEKO_SERIALIZER(ms)
+};
+
+namespace {
+/// Counts the executions alive, the frame of a stopped execution is destroyed with it.
+struct Running {
+    explicit Running(int& count) : count(count) { ++count; }
+    Running(const Running&) = delete;
+    ~Running() { --count; }
+
+    int& count;
+};
+
+auto wait_call(int id, int ms) -> std::string {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) +
+           R"(,"method":"tools/call","params":{"name":"wait","arguments":{"ms":)" + std::to_string(ms) + "}}}";
+}
+
+auto cancel(int id) -> std::string {
+    return R"({"jsonrpc":"2.0","method":"notifications/cancelled","params":{"requestId":)" + std::to_string(id) + "}}";
+}
+} // namespace
+
+int ilias_main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+    ILIAS_NAMESPACE::PlatformContext platform;
+    McpServer<void> server(platform);
+    server.setCapabilities(ToolsCapability{});
+    int started = 0;
+    int running = 0;
+    ToolOptions options;
+    options.coalesce = true;
+    auto wait = [&](WaitParams params) -> ILIAS_NAMESPACE::IoTask<int> {
+        ++started;
+        Running alive(running);
+        if (auto ret = co_await ILIAS_NAMESPACE::sleep(std::chrono::milliseconds(params.ms)); !ret) {
+            co_return ILIAS_NAMESPACE::Err(ret.error());
+        }
+        co_return params.ms;
+    };
+    server.registerToolFunction("wait", std::function(wait), "Wait for ms milliseconds", {}, options);
+    auto loopback = std::make_shared<Loopback>();
+    server.addTransport(LoopbackStream(loopback));
+
+    // Identical calls share one execution, every caller gets the result under its own id.
+    push(*loopback, wait_call(1, 50));
+    push(*loopback, wait_call(2, 50));
+    co_await wait_responses(*loopback, 2);
+    CHECK(started == 1);
+    CHECK(loopback->responses[0].find(R"("id":1,)") != std::string::npos);
+    CHECK(loopback->responses[1].find(R"("id":2,)") != std::string::npos);
+    CHECK(loopback->responses[1].find(R"("isError":false)") != std::string::npos);
+
+    // One caller leaving does not stop the others.
+    push(*loopback, wait_call(3, 400));
+    push(*loopback, wait_call(4, 400));
+    co_await settle();
+    CHECK(started == 2 && running == 1);
+    push(*loopback, cancel(3));
+    co_await settle();
+    CHECK(running == 1);
+
+    // The last caller leaving stops it, nobody is answered.
+    push(*loopback, cancel(4));
+    co_await settle();
+    CHECK(running == 0);
+    CHECK(loopback->responses.size() == 2);
+
+    // The stopped execution is not joined again, the next identical call starts a new one.
+    push(*loopback, wait_call(5, 400));
+    co_await settle();
+    CHECK(started == 3 && running == 1);
+    push(*loopback, cancel(5));
+    co_await settle();
+    CHECK(running == 0);
+
+    server.close();
+    std::cout << "coalesce: " << check_failures() << " failures" << std::endl;
+    co_return check_failures() == 0 ? 0 : 1;
+}
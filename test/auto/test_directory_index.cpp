@@ -0,0 +1,112 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ccmcp/server/directory_index.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+auto write_file(const std::filesystem::path& path, std::string_view content) -> void {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream << content;
+}
+
+auto names(const std::vector<Resource>& resources) -> std::vector<std::string> {
+    std::vector<std::string> result;
+    for (const auto& resource : resources) {
+        result.push_back(resource.name);
+    }
+    return result;
+}
+
+auto test_listing(const std::filesystem::path& root) -> void {
+    write_file(root / "b.txt", "bb");
+    write_file(root / "a dir" / "z.txt", "z");
+    write_file(root / "a dir" / "nested" / "x#1.txt", "x");
+    write_file(root / "c.txt", "");
+    detail::DirectoryIndex index(root, FileResourceOptions{});
+
+    // Depth first, sorted by name in every directory.
+    std::vector<Resource> all;
+    std::string last;
+    CHECK(!index.list("", 0, all, last));
+    const std::vector<std::string> expected = {"a dir/nested/x#1.txt", "a dir/z.txt", "b.txt", "c.txt"};
+    CHECK(names(all) == expected);
+    CHECK(last == "c.txt");
+    CHECK(all.size() == 4 && all[2].metadata && all[2].metadata->size == 2);
+
+    // Pages of two resume after the last relative path and add up to the full listing.
+    std::vector<Resource> paged;
+    std::string after;
+    int pages = 0;
+    while (true) {
+        std::vector<Resource> page;
+        const bool more = index.list(after, 2, page, last);
+        CHECK(page.size() <= 2);
+        paged.insert(paged.end(), page.begin(), page.end());
+        ++pages;
+        if (!more || pages > 4) {
+            break;
+        }
+        after = last;
+    }
+    CHECK(names(paged) == expected);
+
+    // A file added before the cursor is not listed again, one after it shows up.
+    write_file(root / "a dir" / "a.txt", "new");
+    write_file(root / "d.txt", "new");
+    std::vector<Resource> rest;
+    index.list("b.txt", 0, rest, last);
+    CHECK((names(rest) == std::vector<std::string>{"c.txt", "d.txt"}));
+}
+
+auto test_uris(const std::filesystem::path& root) -> void {
+    detail::DirectoryIndex index(root, FileResourceOptions{});
+    std::vector<Resource> all;
+    std::string last;
+    index.list("", 0, all, last);
+    CHECK(!all.empty() && all.front().name == "a dir/a.txt");
+    // Every segment is percent-encoded and resolves back to the file.
+    const auto& nested = all[1];
+    CHECK(nested.name == "a dir/nested/x#1.txt");
+    CHECK(nested.uri == std::string(index.uriPrefix()) + "a%20dir/nested/x%231.txt");
+    auto file = index.resolve(nested.uri);
+    CHECK(file && std::filesystem::equivalent(file->path, root / "a dir" / "nested" / "x#1.txt"));
+    // Nothing outside of the root, encoded dot segments included.
+    CHECK(!index.resolve(std::string(index.uriPrefix()) + "../outside.txt"));
+    CHECK(!index.resolve(std::string(index.uriPrefix()) + "%2E%2E%2Foutside.txt"));
+    CHECK(!index.resolve(std::string(index.uriPrefix())));
+    CHECK(!index.resolve("file:///elsewhere/b.txt"));
+    // A way back into the root is fine.
+    CHECK(index.resolve(std::string(index.uriPrefix()) + "a%20dir/../b.txt"));
+
+    // A file rewritten in place reports its new size.
+    write_file(root / "b.txt", "longer content");
+    std::filesystem::last_write_time(root / "b.txt",
+                                     std::filesystem::last_write_time(root / "b.txt") + std::chrono::seconds(2));
+    all.clear();
+    index.list("", 0, all, last);
+    for (const auto& resource : all) {
+        if (resource.name == "b.txt") {
+            CHECK(resource.metadata && resource.metadata->size == 14);
+        }
+    }
+}
+} // namespace
+
+int main() {
+    const auto root = std::filesystem::temp_directory_path() / "ccmcp_test_directory_index";
+    std::filesystem::remove_all(root);
+    test_listing(root);
+    test_uris(root);
+    std::filesystem::remove_all(root);
+    std::cout << "directory index: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
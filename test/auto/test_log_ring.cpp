@@ -0,0 +1,94 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ccmcp/server/logging.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+auto record(std::string text) -> detail::LogRecord {
+    return detail::LogRecord{.level = LogLevel::Info, .logger = "test", .text = std::move(text)};
+}
+
+auto test_levels() -> void {
+    CHECK(log_level_from_string("warning") == LogLevel::Warning);
+    CHECK(log_level_from_string("emergency") == LogLevel::Emergency);
+    CHECK(!log_level_from_string("off"));
+    CHECK(!log_level_from_string("WARNING"));
+    CHECK(log_level_name(LogLevel::Notice) == "notice");
+    CHECK(log_level_name(LogLevel::Off).empty());
+}
+
+auto test_single_thread() -> void {
+    // Rounded up to a power of two.
+    detail::LogRing ring(3);
+    detail::LogRecord out;
+    CHECK(!ring.tryPop(out));
+    for (int idx = 0; idx < 4; ++idx) {
+        auto in = record(std::to_string(idx));
+        CHECK(ring.tryPush(in));
+    }
+    // A rejected record is left with the caller.
+    auto full = record("full");
+    CHECK(!ring.tryPush(full));
+    CHECK(full.text == "full");
+    for (int idx = 0; idx < 4; ++idx) {
+        CHECK(ring.tryPop(out) && out.text == std::to_string(idx));
+    }
+    CHECK(!ring.tryPop(out));
+    // The cells are reused once the consumer went past them.
+    for (int round = 0; round < 10; ++round) {
+        auto in = record("again");
+        CHECK(ring.tryPush(in));
+        CHECK(ring.tryPop(out) && out.text == "again");
+    }
+}
+
+auto test_producers() -> void {
+    constexpr int kProducers = 4;
+    constexpr int kRecords   = 20000;
+    detail::LogRing ring(64);
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < kProducers; ++producer) {
+        producers.emplace_back([&ring, producer]() {
+            for (int idx = 0; idx < kRecords; ++idx) {
+                auto in = record(std::to_string(producer) + ":" + std::to_string(idx));
+                while (!ring.tryPush(in)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    // Every record arrives once, in order per producer.
+    std::vector<int> next(kProducers, 0);
+    bool ordered = true;
+    detail::LogRecord out;
+    for (int received = 0; received < kProducers * kRecords;) {
+        if (!ring.tryPop(out)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const auto sep      = out.text.find(':');
+        const auto producer = std::stoi(out.text.substr(0, sep));
+        ordered             = ordered && std::stoi(out.text.substr(sep + 1)) == next[producer]++;
+        ++received;
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    CHECK(ordered);
+    CHECK(!ring.tryPop(out));
+}
+} // namespace
+
+int main() {
+    test_levels();
+    test_single_thread();
+    test_producers();
+    std::cout << "log ring: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
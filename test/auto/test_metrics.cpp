@@ -0,0 +1,84 @@
+#include <iostream>
+#include <string>
+
+#include "ccmcp/server/metrics.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+using Histogram = LatencyHistogram;
+
+auto test_buckets() -> void {
+    // Values below kSubBuckets get one bucket each.
+    for (uint64_t value = 0; value < Histogram::kSubBuckets; ++value) {
+        CHECK(Histogram::bucketIndex(value) == value);
+        CHECK(Histogram::bucketUpperBound(value) == value);
+    }
+    // Every value lies in its bucket, the buckets are contiguous and within 1/kSubBuckets of the value.
+    bool inside = true;
+    bool tight  = true;
+    for (uint64_t value = 1; value < (uint64_t(1) << 20); value += 1 + value / 97) {
+        const auto index = Histogram::bucketIndex(value);
+        const auto upper = Histogram::bucketUpperBound(index);
+        const auto lower = index == 0 ? 0 : Histogram::bucketUpperBound(index - 1) + 1;
+        inside           = inside && lower <= value && value <= upper;
+        tight            = tight && (upper - lower) * Histogram::kSubBuckets <= value;
+    }
+    CHECK(inside);
+    CHECK(tight);
+    bool contiguous = true;
+    for (std::size_t index = 1; index < Histogram::kBucketCount; ++index) {
+        const auto lower = Histogram::bucketUpperBound(index - 1) + 1;
+        contiguous       = contiguous && Histogram::bucketIndex(lower) == index &&
+                     Histogram::bucketIndex(Histogram::bucketUpperBound(index)) == index;
+    }
+    CHECK(contiguous);
+    // Values past the range are clamped into the last bucket.
+    CHECK(Histogram::bucketIndex(uint64_t(1) << Histogram::kMaxBits) == Histogram::kBucketCount - 1);
+    CHECK(Histogram::bucketIndex(UINT64_MAX) == Histogram::kBucketCount - 1);
+    CHECK(Histogram::bucketUpperBound(Histogram::kBucketCount - 1) == (uint64_t(1) << Histogram::kMaxBits) - 1);
+}
+
+auto test_percentiles() -> void {
+    Histogram histogram;
+    CHECK(histogram.percentile(0.5) == 0);
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value);
+    }
+    CHECK(histogram.count() == 1000);
+    CHECK(histogram.sum() == 500500);
+    CHECK(histogram.max() == 1000);
+    // Reported as the bucket upper bound, at most 1/kSubBuckets above the exact value.
+    const auto p50 = histogram.percentile(0.5);
+    CHECK(p50 >= 500 && p50 <= 500 + 500 / Histogram::kSubBuckets);
+    const auto p99 = histogram.percentile(0.99);
+    CHECK(p99 >= 990 && p99 <= 1000);
+    // Never above the largest recorded value.
+    CHECK(histogram.percentile(1.0) == 1000);
+    CHECK(histogram.percentile(0.0) == 1);
+}
+
+auto test_exposition() -> void {
+    MetricsRegistry registry;
+    auto& metrics = registry.tool("say \"hi\"");
+    CHECK(&registry.tool("say \"hi\"") == &metrics);
+    metrics.record(3, false);
+    metrics.record(100, true);
+    const auto text = registry.exposition();
+    CHECK(text.find("mcp_tool_calls_total{tool=\"say \\\"hi\\\"\"} 2\n") != std::string::npos);
+    CHECK(text.find("mcp_tool_errors_total{tool=\"say \\\"hi\\\"\"} 1\n") != std::string::npos);
+    CHECK(text.find(",le=\"3\"} 1\n") != std::string::npos);
+    CHECK(text.find(",le=\"+Inf\"} 2\n") != std::string::npos);
+    CHECK(text.find("mcp_tool_latency_microseconds_sum{tool=\"say \\\"hi\\\"\"} 103\n") != std::string::npos);
+}
+} // namespace
+
+int main() {
+    test_buckets();
+    test_percentiles();
+    test_exposition();
+    std::cout << "metrics: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
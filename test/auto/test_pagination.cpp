@@ -0,0 +1,45 @@
+#include <iostream>
+#include <string>
+
+#include "ccmcp/server/pagination.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+auto test_round_trip() -> void {
+    for (std::string_view key : {"", "add", "file:///a b/c.txt", "0:dir/\xE6\xBC\xA2", "with:colons:inside"}) {
+        const auto cursor = detail::encode_cursor("tools", key);
+        CHECK(cursor.find_first_not_of("0123456789abcdef") == std::string::npos);
+        CHECK(detail::decode_cursor("tools", cursor) == std::string(key));
+    }
+}
+
+auto test_scopes() -> void {
+    const auto cursor = detail::encode_cursor("resources", "file:///x");
+    CHECK(!detail::decode_cursor("tools", cursor));
+    // A scope that is a prefix of another one does not accept its cursors.
+    CHECK(!detail::decode_cursor("resources", detail::encode_cursor("resources/dir", "0:x")));
+    CHECK(!detail::decode_cursor("resources/dir", cursor));
+    CHECK(!detail::decode_cursor("resources/templates", cursor));
+}
+
+auto test_malformed() -> void {
+    const auto cursor = detail::encode_cursor("tools", "add");
+    CHECK(!detail::decode_cursor("tools", ""));
+    CHECK(!detail::decode_cursor("tools", cursor.substr(1)));
+    CHECK(!detail::decode_cursor("tools", cursor + "g0"));
+    CHECK(!detail::decode_cursor("tools", "746F6F6C733A616464")); // upper case digits are never issued
+    // Scope without the separator.
+    CHECK(!detail::decode_cursor("tools", "746f6f6c73"));
+}
+} // namespace
+
+int main() {
+    test_round_trip();
+    test_scopes();
+    test_malformed();
+    std::cout << "pagination: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <string>
+
+#include "ccmcp/model/raw_message.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+auto canonical(std::string_view json) -> std::string {
+    std::string out;
+    return detail::json_append_canonical(out, json) ? out : "<malformed>";
+}
+
+auto escaped(std::string_view text) -> std::string {
+    std::string out;
+    detail::json_append_string(out, text);
+    return out;
+}
+
+auto test_parse() -> void {
+    auto message = RawMessage::parse(R"( { "jsonrpc" : "2.0", "id" : 7, "method" : "tools/call", )"
+                                     R"("params" : {"name":"add","arguments":{"a":[1,"}"]}} } )");
+    CHECK(message.has_value());
+    CHECK(message->id == "7");
+    CHECK(message->method == "tools/call");
+    CHECK(message->params == R"({"name":"add","arguments":{"a":[1,"}"]}})");
+    CHECK(!message->isNotification());
+
+    message = RawMessage::parse(R"({"jsonrpc":"2.0","id":"a\"b","method":"ping"})");
+    CHECK(message && message->id == R"("a\"b")" && message->method == "ping" && message->params.empty());
+
+    // Notifications and null ids have no id, a method with escapes is left for the full parser.
+    message = RawMessage::parse(R"({"jsonrpc":"2.0","method":"notifications/initialized"})");
+    CHECK(message && message->isNotification());
+    message = RawMessage::parse(R"({"id":null,"method":"a\/b"})");
+    CHECK(message && message->isNotification() && message->method.empty());
+    CHECK(RawMessage::parse("{}").has_value());
+
+    CHECK(!RawMessage::parse(""));
+    CHECK(!RawMessage::parse("[]"));
+    CHECK(!RawMessage::parse(R"({"id":1,})"));
+    CHECK(!RawMessage::parse(R"({"id":1 "method":"x"})"));
+    CHECK(!RawMessage::parse(R"({"id":1,"params":{"a":1})"));
+    CHECK(!RawMessage::parse(R"({"id":1,"method":"unterminated})"));
+}
+
+auto test_member() -> void {
+    constexpr std::string_view object = R"({"a":1, "b" : {"c":[true,null]}, "text":"x,}\"y", "last":false})";
+    CHECK(detail::json_member(object, "a") == "1");
+    CHECK(detail::json_member(object, "b") == R"({"c":[true,null]})");
+    CHECK(detail::json_member(object, "text") == R"("x,}\"y")");
+    CHECK(detail::json_member(object, "last") == "false");
+    // Only top level members are found.
+    CHECK(!detail::json_member(object, "c"));
+    CHECK(!detail::json_member(object, "missing"));
+    CHECK(!detail::json_member("{}", "a"));
+    CHECK(!detail::json_member("[1]", "a"));
+    CHECK(!detail::json_member(R"({"a" 1})", "a"));
+
+    auto members = detail::json_members(R"({"z":1,"a":[2]})");
+    CHECK(members && members->size() == 2 && (*members)[0].first == "z" && (*members)[1].second == "[2]");
+    CHECK(detail::json_members("{ }") && detail::json_members("{ }")->empty());
+    CHECK(!detail::json_members(R"({"a":1,})"));
+
+    auto elements = detail::json_elements(R"([1, "two", {"three":3}, [4]])");
+    CHECK(elements && elements->size() == 4 && (*elements)[2] == R"({"three":3})");
+    CHECK(detail::json_elements("[]") && detail::json_elements("[]")->empty());
+    CHECK(!detail::json_elements("[1,"));
+
+    CHECK(detail::json_plain_string(R"("plain")") == "plain");
+    CHECK(!detail::json_plain_string(R"("esc\n")"));
+    CHECK(!detail::json_plain_string("12"));
+}
+
+auto test_writers() -> void {
+    CHECK(escaped("plain") == R"("plain")");
+    CHECK(escaped("a\"b\\c\nd\te\r") == R"("a\"b\\c\nd\te\r")");
+    CHECK(escaped(std::string_view("\x01\x1f", 2)) == R"("\u0001\u001f")");
+    CHECK(escaped("\xE6\xBC\xA2") == "\"\xE6\xBC\xA2\"");
+
+    // Equal documents give equal strings whatever the member order and whitespace.
+    CHECK(canonical(R"({ "b" : [ 1 , {"y":2,"x":1} ], "a" : "s p" })") == R"({"a":"s p","b":[1,{"x":1,"y":2}]})");
+    CHECK(canonical(R"({"x":1,"y":2})") == canonical(R"({"y":2, "x":1})"));
+    CHECK(canonical(" 42 ") == "42");
+    CHECK(canonical(R"({"a":)") == "<malformed>");
+
+    CHECK(detail::make_raw_result("3", R"({"ok":true})") == R"({"jsonrpc":"2.0","id":3,"result":{"ok":true}})");
+    CHECK(detail::make_raw_error("", -32602, "Invalid \"level\"") ==
+          R"({"jsonrpc":"2.0","id":null,"error":{"code":-32602,"message":"Invalid \"level\""}})");
+}
+} // namespace
+
+int main() {
+    test_parse();
+    test_member();
+    test_writers();
+    std::cout << "raw message: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
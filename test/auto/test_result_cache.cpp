@@ -0,0 +1,101 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "ccmcp/server/result_cache.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+using Cache = detail::ToolResultCache;
+
+constexpr auto kTtl = std::chrono::minutes(1);
+
+auto result(std::string text) -> std::shared_ptr<const std::string> {
+    return std::make_shared<const std::string>(std::move(text));
+}
+
+auto test_keys() -> void {
+    // Member order and spacing do not matter, values and the tool do.
+    CHECK(Cache::makeKey("add", R"({"a":1,"b":2})") == Cache::makeKey("add", R"( { "b" : 2, "a" : 1 } )"));
+    CHECK(Cache::makeKey("add", R"({"a":1})") != Cache::makeKey("add", R"({"a":2})"));
+    CHECK(Cache::makeKey("add", R"({"a":1})") != Cache::makeKey("sub", R"({"a":1})"));
+    // Missing arguments are the empty object.
+    CHECK(Cache::makeKey("now", "") == Cache::makeKey("now", "{}"));
+    CHECK(Cache::makeKey("now", "null") == Cache::makeKey("now", "{}"));
+    CHECK(Cache::makeKey("add", R"({"a":)").empty());
+}
+
+auto test_lru() -> void {
+    Cache cache;
+    CHECK(!cache.enabled());
+    cache.insert(Cache::makeKey("t", "{}"), result("r"), kTtl);
+    CHECK(cache.size() == 0);
+
+    cache.setCapacity(1 << 20);
+    const auto a = Cache::makeKey("t", R"({"k":"a"})");
+    const auto b = Cache::makeKey("t", R"({"k":"b"})");
+    const auto c = Cache::makeKey("t", R"({"k":"c"})");
+    const auto d = Cache::makeKey("t", R"({"k":"d"})");
+    cache.insert(a, result("A"), kTtl);
+    cache.insert(b, result("B"), kTtl);
+    cache.insert(c, result("C"), kTtl);
+    CHECK(cache.size() == 3);
+    // Entries of equal size, the cache is now full with three of them.
+    cache.setCapacity(cache.bytes());
+    CHECK(cache.size() == 3);
+    CHECK(cache.find(a) && *cache.find(a) == "A");
+    // b is now the least recently used and goes first.
+    cache.insert(d, result("D"), kTtl);
+    CHECK(cache.find(b) == nullptr);
+    CHECK(cache.find(a) != nullptr && cache.find(c) != nullptr && cache.find(d) != nullptr);
+    CHECK(cache.bytes() <= cache.capacity());
+    CHECK(cache.hits() == 5 && cache.misses() == 1);
+
+    // Inserting a key again replaces its result without growing the cache.
+    cache.insert(a, result("2"), kTtl);
+    CHECK(cache.size() == 3 && *cache.find(a) == "2");
+
+    // A result larger than the capacity is not kept.
+    cache.insert(b, result(std::string(cache.capacity(), 'x')), kTtl);
+    CHECK(cache.find(b) == nullptr);
+    CHECK(cache.bytes() <= cache.capacity());
+
+    cache.setCapacity(0);
+    CHECK(cache.size() == 0 && cache.bytes() == 0);
+}
+
+auto test_expiry_and_invalidation() -> void {
+    Cache cache;
+    cache.setCapacity(1 << 20);
+    const auto shortKey = Cache::makeKey("clock", "{}");
+    cache.insert(shortKey, result("now"), std::chrono::milliseconds(10));
+    cache.insert(Cache::makeKey("never", "{}"), result("x"), std::chrono::milliseconds(0));
+    CHECK(cache.size() == 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(cache.find(shortKey) == nullptr);
+    CHECK(cache.size() == 0);
+
+    cache.insert(Cache::makeKey("add", R"({"a":1})"), result("1"), kTtl);
+    cache.insert(Cache::makeKey("add", R"({"a":2})"), result("2"), kTtl);
+    cache.insert(Cache::makeKey("addition", "{}"), result("3"), kTtl);
+    // Only the exact tool name, not the ones it prefixes.
+    CHECK(cache.invalidate("add") == 2);
+    CHECK(cache.size() == 1);
+    CHECK(cache.find(Cache::makeKey("addition", "{}")) != nullptr);
+    cache.clear();
+    CHECK(cache.size() == 0 && cache.bytes() == 0);
+}
+} // namespace
+
+int main() {
+    test_keys();
+    test_lru();
+    test_expiry_and_invalidation();
+    std::cout << "result cache: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <ilias/platform.hpp>
+#include <ilias/task.hpp>
+
+#include "ccmcp/server/server.hpp"
+
+#include "check.hpp"
+#include "loopback.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+auto subscribe(int id, std::string_view uri) -> std::string {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) + R"(,"method":"resources/subscribe","params":{"uri":")" +
+           std::string(uri) + R"("}})";
+}
+
+auto updated(const Loopback& loopback, std::string_view uri) -> bool {
+    for (const auto& message : loopback.responses) {
+        if (message.find("notifications/resources/updated") != std::string::npos &&
+            message.find(uri) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+int ilias_main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+    ILIAS_NAMESPACE::PlatformContext platform;
+    McpServer<void> server(platform);
+    server.setCapabilities(ResourcesCapability{.subscribe = true, .listChanged = {}});
+    auto first  = std::make_shared<Loopback>();
+    auto second = std::make_shared<Loopback>();
+    server.addTransport(LoopbackStream(first));
+    server.addTransport(LoopbackStream(second));
+
+    push(*first, subscribe(1, "file:///shared"));
+    push(*first, subscribe(2, "file:///first"));
+    push(*second, subscribe(1, "file:///shared"));
+    co_await wait_responses(*first, 2);
+    co_await wait_responses(*second, 1);
+    CHECK(server.subscriptions().size() == 2);
+
+    // A session that goes away takes its subscriptions with it, the ones of other sessions stay.
+    disconnect(*first);
+    co_await settle();
+    CHECK(server.subscriptions().size() == 1);
+    CHECK(!server.subscriptions().subscribed("file:///first"));
+    CHECK(server.subscriptions().subscribed("file:///shared"));
+
+    const auto sent = first->responses.size();
+    server.notifyResourceUpdated("file:///shared");
+    server.notifyResourceUpdated("file:///first");
+    co_await settle();
+    CHECK(updated(*second, "file:///shared"));
+    CHECK(first->responses.size() == sent);
+
+    server.close();
+    std::cout << "subscriptions: " << check_failures() << " failures" << std::endl;
+    co_return check_failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ccmcp/server/tool_dispatch.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+constexpr std::string_view kNames[] = {"add", "sub", "mul", "div", "read_file", "write_file", "list", "search"};
+
+// Built at compile time, find() on it is a constant expression as well.
+constexpr auto static_find(std::string_view name) -> std::size_t {
+    detail::PerfectHashIndex index(kNames);
+    return index.find(name);
+}
+static_assert(static_find("div") == 3);
+static_assert(static_find("nope") == detail::PerfectHashIndex::npos);
+
+auto test_perfect_hash() -> void {
+    detail::PerfectHashIndex empty;
+    CHECK(empty.empty());
+    CHECK(empty.find("add") == detail::PerfectHashIndex::npos);
+
+    detail::PerfectHashIndex index(kNames);
+    CHECK(index.size() == std::size(kNames));
+    for (std::size_t idx = 0; idx < std::size(kNames); ++idx) {
+        CHECK(index.find(kNames[idx]) == idx);
+    }
+    CHECK(index.find("") == detail::PerfectHashIndex::npos);
+    CHECK(index.find("ad") == detail::PerfectHashIndex::npos);
+    CHECK(index.find("add ") == detail::PerfectHashIndex::npos);
+
+    // A larger set still gets every name its own slot.
+    std::vector<std::string> owned;
+    for (int idx = 0; idx < 2000; ++idx) {
+        owned.push_back("tool_" + std::to_string(idx));
+    }
+    std::vector<std::string_view> names(owned.begin(), owned.end());
+    CHECK(index.build(names));
+    bool all = true;
+    for (std::size_t idx = 0; idx < names.size(); ++idx) {
+        all = all && index.find(names[idx]) == idx;
+    }
+    CHECK(all);
+    CHECK(index.find("tool_2000") == detail::PerfectHashIndex::npos);
+}
+
+auto test_flat_map() -> void {
+    detail::FlatToolMap<int> map;
+    CHECK(map.find("a") == nullptr);
+    CHECK(!map.erase("a"));
+
+    // Keys are copied, the temporaries may go away.
+    for (int idx = 0; idx < 100; ++idx) {
+        CHECK(map.insert("tool_" + std::to_string(idx), idx));
+    }
+    CHECK(!map.insert("tool_7", -1));
+    CHECK(map.size() == 100);
+    CHECK(map.find("tool_7") != nullptr && *map.find("tool_7") == 7);
+    *map.find("tool_7") = 70;
+    CHECK(*map.find("tool_7") == 70);
+
+    // Erasing every other key must not break the probe chains of the ones left.
+    for (int idx = 0; idx < 100; idx += 2) {
+        CHECK(map.erase("tool_" + std::to_string(idx)));
+    }
+    CHECK(map.size() == 50);
+    bool intact = true;
+    for (int idx = 0; idx < 100; ++idx) {
+        const auto* value = map.find("tool_" + std::to_string(idx));
+        intact            = intact && (idx % 2 == 0 ? value == nullptr : value != nullptr);
+    }
+    CHECK(intact);
+
+    std::set<std::string> seen;
+    map.forEach([&](std::string_view name, int) { seen.emplace(name); });
+    CHECK(seen.size() == 50);
+    CHECK(seen.contains("tool_1") && !seen.contains("tool_0"));
+}
+
+auto test_dispatch_table() -> void {
+    detail::ToolDispatchTable<int> table;
+    CHECK(table.setStatic({"add", "sub"}, {std::make_shared<int>(1), std::make_shared<int>(2)}));
+    CHECK(!table.setStatic({"only_a_name"}, {}));
+    CHECK(table.insert("dynamic", std::make_shared<int>(3)));
+    // Static names cannot be registered again.
+    CHECK(!table.insert("add", std::make_shared<int>(4)));
+    CHECK(!table.insert("dynamic", std::make_shared<int>(5)));
+    CHECK(table.size() == 3);
+    CHECK(table.find("add") != nullptr && *table.find("add") == 1);
+    CHECK(table.find("dynamic") != nullptr && *table.find("dynamic") == 3);
+    CHECK(table.find("missing") == nullptr);
+
+    // A copy is a registry version, replacing a handler in one leaves the other serving the old handler.
+    auto copy = table;
+    auto held = table.get("add");
+    CHECK(copy.replace("add", std::make_shared<int>(10)));
+    CHECK(copy.replace("dynamic", std::make_shared<int>(30)));
+    CHECK(!copy.replace("missing", std::make_shared<int>(0)));
+    CHECK(*copy.find("add") == 10 && *copy.find("dynamic") == 30);
+    CHECK(*table.find("add") == 1 && *table.find("dynamic") == 3);
+    CHECK(held.get() == table.find("add"));
+
+    // Only dynamic tools can be removed.
+    CHECK(!copy.erase("add"));
+    CHECK(copy.erase("dynamic"));
+    CHECK(!copy.contains("dynamic") && table.contains("dynamic"));
+
+    std::vector<std::string> order;
+    table.forEach([&](std::string_view name, const int&) { order.emplace_back(name); });
+    CHECK((order == std::vector<std::string>{"add", "sub", "dynamic"}));
+}
+} // namespace
+
+int main() {
+    test_perfect_hash();
+    test_flat_map();
+    test_dispatch_table();
+    std::cout << "tool dispatch: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <iostream>
+#include <stop_token>
+
+#include <ilias/platform.hpp>
+#include <ilias/sync/event.hpp>
+#include <ilias/task.hpp>
+
+#include "ccmcp/server/tool_limiter.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+using Limiter = detail::ToolLimiter;
+
+/// Take a slot and keep it until `release` is set, `outcome` is 1 once running and -1 if it was canceled.
+auto hold(Limiter& limiter, ILIAS_NAMESPACE::IoContext& context, Limiter::Admission admission, std::stop_token stop,
+          int& outcome, ILIAS_NAMESPACE::Event& release) -> ILIAS_NAMESPACE::Task<void> {
+    auto permit = co_await limiter.acquire(std::move(admission), context, 1, std::move(stop));
+    outcome     = permit ? 1 : -1;
+    if (permit) {
+        co_await release;
+    }
+}
+
+/// Let the resumes posted by the limiter run.
+auto settle() -> ILIAS_NAMESPACE::Task<void> { (void)co_await ILIAS_NAMESPACE::sleep(std::chrono::milliseconds(10)); }
+} // namespace
+
+int ilias_main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+    ILIAS_NAMESPACE::PlatformContext platform;
+    Limiter limiter;
+
+    // A place that never becomes a call is given back.
+    {
+        auto admission = limiter.tryAdmit(1, 1);
+        CHECK(admission && limiter.queued() == 1);
+    }
+    CHECK(limiter.queued() == 0);
+
+    ILIAS_NAMESPACE::Event release;
+    int first = 0, second = 0, third = 0;
+    std::stop_source firstStop, secondStop, thirdStop;
+    auto running = ILIAS_NAMESPACE::spawn(
+        hold(limiter, platform, limiter.tryAdmit(1, 1), firstStop.get_token(), first, release));
+    co_await settle();
+    CHECK(first == 1 && limiter.running() == 1);
+
+    // Stopping a queued call frees its place right away and ends it as canceled.
+    auto queued = ILIAS_NAMESPACE::spawn(
+        hold(limiter, platform, limiter.tryAdmit(1, 1), secondStop.get_token(), second, release));
+    co_await settle();
+    CHECK(second == 0 && limiter.queued() == 1);
+    CHECK(!limiter.tryAdmit(1, 1));
+    secondStop.request_stop();
+    CHECK(limiter.queued() == 0);
+    co_await settle();
+    CHECK(second == -1);
+
+    // The freed place is taken by the next call, which runs once the slot is given back.
+    auto next = ILIAS_NAMESPACE::spawn(
+        hold(limiter, platform, limiter.tryAdmit(1, 1), thirdStop.get_token(), third, release));
+    co_await settle();
+    CHECK(third == 0 && limiter.queued() == 1);
+    release.set();
+    co_await settle();
+    CHECK(first == 1 && third == 1);
+    CHECK(limiter.running() == 0 && limiter.queued() == 0);
+
+    // A call stopped before it asks for a slot is not queued at all.
+    std::stop_source stopped;
+    stopped.request_stop();
+    int late = 0;
+    auto canceled = ILIAS_NAMESPACE::spawn(
+        hold(limiter, platform, limiter.tryAdmit(1, 1), stopped.get_token(), late, release));
+    co_await settle();
+    CHECK(late == -1 && limiter.queued() == 0);
+
+    std::cout << "tool limiter: " << check_failures() << " failures" << std::endl;
+    co_return check_failures() == 0 ? 0 : 1;
+}
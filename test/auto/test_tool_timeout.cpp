@@ -0,0 +1,85 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ilias/platform.hpp>
+#include <ilias/task.hpp>
+
+#include "ccmcp/server/server.hpp"
+
+#include "check.hpp"
+#include "loopback.hpp"
+
+CCMCP_USE_NAMESPACE
+
+struct SleepParams {
+    int ms = 0;
+
+    NEKO_SERIALIZER(ms)
+};
+
+auto sleep_call(int id, int ms) -> std::string {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) +
+           R"(,"method":"tools/call","params":{"name":"sleep","arguments":{"ms":)" + std::to_string(ms) + "}}}";
+}
+
+/// Time until the response to `request` arrives.
+auto round_trip(Loopback& loopback, std::string request) -> ILIAS_NAMESPACE::Task<std::chrono::milliseconds> {
+    const auto count = loopback.responses.size() + 1;
+    const auto start = std::chrono::steady_clock::now();
+    push(loopback, std::move(request));
+    co_await wait_responses(loopback, count);
+    co_return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+int ilias_main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+    ILIAS_NAMESPACE::PlatformContext platform;
+    McpServer<void> server(platform);
+    server.setCapabilities(ToolsCapability{});
+    // A synchronous tool that ignores the stop token, only the executor can keep the deadline for it.
+    ToolOptions options;
+    options.timeout        = std::chrono::milliseconds(50);
+    options.maxConcurrency = 1;
+    server.setToolExecutor(std::make_shared<ToolExecutor>(2));
+    server.registerToolFunction("sleep", std::function([](SleepParams params) {
+                                    std::this_thread::sleep_for(std::chrono::milliseconds(params.ms));
+                                    return params.ms;
+                                }),
+                                "Sleep for ms milliseconds", {}, options);
+    auto loopback = std::make_shared<Loopback>();
+    server.addTransport(LoopbackStream(loopback));
+
+    // Past the deadline the call is answered right away, without waiting for the tool.
+    auto elapsed = co_await round_trip(*loopback, sleep_call(1, 400));
+    CHECK(elapsed < std::chrono::milliseconds(300));
+    CHECK(loopback->responses.back().find(R"("isError":true)") != std::string::npos);
+    CHECK(loopback->responses.back().find("timed out") != std::string::npos);
+
+    // The timed out call gave its permit back, the next one runs although the first tool is still sleeping.
+    elapsed = co_await round_trip(*loopback, sleep_call(2, 1));
+    CHECK(elapsed < std::chrono::milliseconds(300));
+    CHECK(loopback->responses.back().find(R"("isError":false)") != std::string::npos);
+
+    // A request can shorten the deadline, not extend it.
+    elapsed = co_await round_trip(
+        *loopback, R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"sleep","arguments":{"ms":400},)"
+                   R"("_meta":{"timeout":10}}})");
+    CHECK(elapsed < std::chrono::milliseconds(300));
+    CHECK(loopback->responses.back().find("timed out") != std::string::npos);
+
+    // The deadline covers the wait for a running slot, a queued call expires before the one holding the slot.
+    const auto count = loopback->responses.size() + 2;
+    loopback->incoming.push_back(sleep_call(4, 400));
+    loopback->incoming.push_back(
+        R"({"jsonrpc":"2.0","id":5,"method":"tools/call","params":{"name":"sleep","arguments":{"ms":1},)"
+        R"("_meta":{"timeout":10}}})");
+    loopback->incomingEvent.set();
+    co_await wait_responses(*loopback, count);
+    CHECK(loopback->responses[count - 2].find(R"("id":5)") != std::string::npos);
+    CHECK(loopback->responses[count - 2].find("timed out") != std::string::npos);
+
+    server.close();
+    co_return check_failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <string>
+
+#include "ccmcp/server/uri_template.hpp"
+
+#include "check.hpp"
+
+CCMCP_USE_NAMESPACE
+
+namespace {
+auto matched(const detail::UriTemplateMatcher& matcher, std::string_view uri) -> std::size_t {
+    auto match = matcher.match(uri);
+    return match ? match->value : static_cast<std::size_t>(-1);
+}
+
+auto variable(const detail::UriTemplateMatcher& matcher, std::string_view uri, std::string_view name)
+    -> std::string {
+    auto match = matcher.match(uri);
+    if (!match) {
+        return "<no match>";
+    }
+    auto it = match->variables.find(name);
+    return it == match->variables.end() ? "<unset>" : it->second;
+}
+
+auto test_malformed() -> void {
+    detail::UriTemplateMatcher matcher;
+    CHECK(!matcher.insert("db://{", 0));
+    CHECK(!matcher.insert("db://}x", 0));
+    CHECK(!matcher.insert("db://{a}{b}", 0));
+    CHECK(!matcher.insert("db://{a,b}", 0));
+    CHECK(!matcher.insert("db://{?query}", 0));
+    CHECK(!matcher.insert("db://{+rest}/tail", 0));
+    CHECK(!matcher.insert("db://x{+rest}", 0));
+    CHECK(!matcher.insert("db://{id:3}", 0));
+    CHECK(!matcher.insert("db://{id:}", 0));
+    CHECK(!matcher.insert("db://{+rest:int}", 0));
+    CHECK(matcher.size() == 0);
+}
+
+auto test_duplicates() -> void {
+    detail::UriTemplateMatcher matcher;
+    CHECK(matcher.insert("db://{table}/{id}", 0));
+    // Same shape under other variable names.
+    CHECK(!matcher.insert("db://{name}/{key}", 1));
+    CHECK(!matcher.insert("db://{table}/{id}", 2));
+    CHECK(matcher.insert("db://{table}/{id}.json", 3));
+    CHECK(matcher.size() == 2);
+}
+
+auto test_precedence() -> void {
+    detail::UriTemplateMatcher matcher;
+    CHECK(matcher.insert("db://{+path}", 0));
+    CHECK(matcher.insert("db://{table}/{id}", 1));
+    CHECK(matcher.insert("db://{table}/{id}.json", 2));
+    CHECK(matcher.insert("db://users/{id}", 3));
+    CHECK(matcher.insert("db://users/me", 4));
+
+    CHECK(matched(matcher, "db://users/me") == 4);      // literal
+    CHECK(matched(matcher, "db://users/42") == 3);      // literal then capture
+    CHECK(matched(matcher, "db://orders/7.json") == 2); // prefix/suffix capture over a whole segment
+    CHECK(matched(matcher, "db://orders/7") == 1);
+    CHECK(matched(matcher, "db://a/b/c") == 0);         // only the tail takes slashes
+    CHECK(matched(matcher, "db://single") == 0);
+    CHECK(matched(matcher, "other://users/me") == static_cast<std::size_t>(-1));
+
+    // A literal branch that dead-ends falls back to the captures.
+    CHECK(matched(matcher, "db://users/me/x") == 0);
+    // An empty segment is not captured.
+    CHECK(matched(matcher, "db://orders/") == 0);
+    // The affix needs something between its prefix and suffix.
+    CHECK(matched(matcher, "db://orders/.json") == 1);
+}
+
+auto test_typed() -> void {
+    detail::UriTemplateMatcher matcher;
+    CHECK(matcher.insert("db://{table}/{slug}", 0));
+    CHECK(matcher.insert("db://{table}/{id:int}", 1));
+    CHECK(matcher.insert("db://{table}/row-{key}.json", 2));
+    CHECK(matcher.insert("db://{table}/row-{id:int}.json", 3));
+    // The type is part of the shape.
+    CHECK(!matcher.insert("db://{name}/{key:int}", 4));
+
+    CHECK(matched(matcher, "db://users/42") == 1);
+    CHECK(matched(matcher, "db://users/4x2") == 0);
+    CHECK(matched(matcher, "db://users/row-7.json") == 3);
+    CHECK(matched(matcher, "db://users/row-x.json") == 2);
+    CHECK(variable(matcher, "db://users/42", "id") == "42");
+    CHECK(variable(matcher, "db://users/row-7.json", "id") == "7");
+}
+
+auto test_many_templates() -> void {
+    constexpr std::size_t kTemplates = 2000;
+    detail::UriTemplateMatcher matcher;
+    // Affixes of every prefix length at one node, next to literal and capture branches.
+    for (std::size_t idx = 0; idx < kTemplates; ++idx) {
+        const auto id = std::to_string(idx);
+        CHECK(matcher.insert("db://items/p" + id + "-{id}.json", idx));
+        CHECK(matcher.insert("db://t" + id + "/{id:int}", kTemplates + idx));
+    }
+    CHECK(matcher.insert("db://items/{id}", 2 * kTemplates));
+    CHECK(matcher.insert("db://items/p{id}.json", 2 * kTemplates + 1));
+    CHECK(matcher.size() == 2 * kTemplates + 2);
+
+    bool all = true;
+    for (std::size_t idx = 0; idx < kTemplates; ++idx) {
+        const auto id = std::to_string(idx);
+        all           = all && matched(matcher, "db://items/p" + id + "-x.json") == idx;
+        all           = all && matched(matcher, "db://t" + id + "/12") == kTemplates + idx;
+    }
+    CHECK(all);
+    CHECK(variable(matcher, "db://items/p1999-a-b.json", "id") == "a-b");
+    // The longest matching prefix wins.
+    CHECK(matched(matcher, "db://items/p19-x.json") == 19);
+    CHECK(matched(matcher, "db://items/p1-.json") == 2 * kTemplates + 1);
+    CHECK(matched(matcher, "db://items/p1-x.txt") == 2 * kTemplates);
+    CHECK(matched(matcher, "db://items/q1-x.json") == 2 * kTemplates);
+    CHECK(matched(matcher, "db://t7/x") == static_cast<std::size_t>(-1));
+}
+
+auto test_variables() -> void {
+    detail::UriTemplateMatcher matcher;
+    CHECK(matcher.insert("db://{table}/row-{id}.json", 0));
+    CHECK(matcher.insert("file:///{+path}", 1));
+    CHECK(variable(matcher, "db://users/row-17.json", "table") == "users");
+    CHECK(variable(matcher, "db://users/row-17.json", "id") == "17");
+    CHECK(variable(matcher, "file:///var/log/app.log", "path") == "var/log/app.log");
+    // Captures are decoded, malformed escapes are kept.
+    CHECK(variable(matcher, "db://my%20table/row-a%2Fb.json", "table") == "my table");
+    CHECK(variable(matcher, "db://my%20table/row-a%2Fb.json", "id") == "a/b");
+    CHECK(variable(matcher, "file:///100%25/%zz/%4", "path") == "100%/%zz/%4");
+}
+
+auto test_percent_coding() -> void {
+    CHECK(detail::percent_decode("a%41%62c") == "aAbc");
+    CHECK(detail::percent_decode("%") == "%");
+    CHECK(detail::percent_decode("%4") == "%4");
+    CHECK(detail::percent_decode("%g0") == "%g0");
+
+    std::string encoded;
+    detail::append_percent_encoded(encoded, "dir name/a#bytes=1-2~_.txt", "/");
+    CHECK(encoded == "dir%20name/a%23bytes%3D1-2~_.txt");
+    CHECK(detail::percent_decode(encoded) == "dir name/a#bytes=1-2~_.txt");
+    encoded.clear();
+    detail::append_percent_encoded(encoded, "\xE6\xBC\xA2/");
+    CHECK(encoded == "%E6%BC%A2%2F");
+}
+} // namespace
+
+int main() {
+    test_malformed();
+    test_duplicates();
+    test_precedence();
+    test_typed();
+    test_many_templates();
+    test_variables();
+    test_percent_coding();
+    std::cout << "uri template: " << check_failures() << " failures" << std::endl;
+    return check_failures() == 0 ? 0 : 1;
+}
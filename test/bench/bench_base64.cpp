@@ -0,0 +1,59 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <nekoproto/serialization/types/binary_data.hpp>
+
+#include "ccmcp/server/base64.hpp"
+
+CCMCP_USE_NAMESPACE
+
+template <typename FuncT>
+auto bench(const char* name, std::size_t bytes, int rounds, FuncT&& encode) -> std::string {
+    std::string blob;
+    auto start   = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        blob = encode();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-28s %8.1f MB/s\n", name, double(bytes) * rounds / elapsed / 1e6);
+    return blob;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4 * 1024 * 1024;
+    const int rounds       = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    std::vector<char> buffer(size);
+    std::mt19937 rng(42);
+    for (auto& byte : buffer) {
+        byte = static_cast<char>(rng());
+    }
+    const auto bytes = std::as_bytes(std::span(buffer));
+    std::printf("base64 of %zu bytes, %s encoder\n", size, std::string(detail::base64_implementation()).c_str());
+
+    // What createResourceContentsFromFile() used to do: encode into a temporary, then copy into the blob.
+    auto legacy = bench("Base64Covert + copy", size, rounds, [&] {
+        auto data = NEKO_NAMESPACE::Base64Covert::Encode(buffer);
+        return std::string(data.begin(), data.end());
+    });
+    auto scalar = bench("scalar, in place", size, rounds, [&] {
+        std::string blob(detail::base64_encoded_size(size), '\0');
+        detail::base64_encode_scalar(bytes, blob.data());
+        return blob;
+    });
+    auto simd = bench("dispatched, in place", size, rounds, [&] {
+        std::string blob(detail::base64_encoded_size(size), '\0');
+        detail::base64_encode(bytes, blob.data());
+        return blob;
+    });
+    if (scalar != legacy || simd != legacy) {
+        std::printf("mismatch between encoders\n");
+        return 1;
+    }
+    return 0;
+}
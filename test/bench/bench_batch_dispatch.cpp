@@ -0,0 +1,132 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <ilias/platform.hpp>
+#include <ilias/sync/event.hpp>
+#include <ilias/task.hpp>
+
+#include "ccmcp/server/server.hpp"
+
+CCMCP_USE_NAMESPACE
+
+struct WorkParams {
+    int ms = 0;
+
+    NEKO_SERIALIZER(ms)
+};
+
+/// In memory transport, requests are pushed by the benchmark and responses collected back.
+struct Loopback {
+    std::deque<std::string> incoming;
+    std::vector<std::string> responses;
+    ILIAS_NAMESPACE::Event incomingEvent;
+    ILIAS_NAMESPACE::Event responseEvent;
+    bool closed = false;
+};
+
+class LoopbackStream {
+public:
+    template <typename T>
+    using IoTask = ILIAS_NAMESPACE::IoTask<T>;
+
+    explicit LoopbackStream(std::shared_ptr<Loopback> loopback) : mLoopback(std::move(loopback)) {}
+
+    auto recv(std::vector<std::byte>& buffer) -> IoTask<void> {
+        while (mLoopback->incoming.empty()) {
+            if (mLoopback->closed) {
+                co_return ILIAS_NAMESPACE::Err(ILIAS_NAMESPACE::IoError::Canceled);
+            }
+            mLoopback->incomingEvent.clear();
+            co_await mLoopback->incomingEvent;
+        }
+        auto message = std::move(mLoopback->incoming.front());
+        mLoopback->incoming.pop_front();
+        buffer.resize(message.size());
+        std::memcpy(buffer.data(), message.data(), message.size());
+        co_return {};
+    }
+    auto send(std::span<const std::byte> data) -> IoTask<void> {
+        mLoopback->responses.emplace_back(reinterpret_cast<const char*>(data.data()), data.size());
+        mLoopback->responseEvent.set();
+        co_return {};
+    }
+    auto close() -> void {
+        mLoopback->closed = true;
+        mLoopback->incomingEvent.set();
+    }
+    auto start() -> IoTask<void> { co_return {}; }
+    auto shutdown() -> IoTask<void> { co_return {}; }
+    auto flush() -> IoTask<void> { co_return {}; }
+
+private:
+    std::shared_ptr<Loopback> mLoopback;
+};
+
+auto push(Loopback& loopback, std::string message) -> void {
+    loopback.incoming.push_back(std::move(message));
+    loopback.incomingEvent.set();
+}
+
+auto wait_responses(Loopback& loopback, std::size_t count) -> ILIAS_NAMESPACE::Task<void> {
+    while (loopback.responses.size() < count) {
+        loopback.responseEvent.clear();
+        co_await loopback.responseEvent;
+    }
+}
+
+auto tool_call(int id, int ms) -> std::string {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) +
+           R"(,"method":"tools/call","params":{"name":"work","arguments":{"ms":)" + std::to_string(ms) + "}}}";
+}
+
+int ilias_main(int argc, char** argv) {
+    const int calls = argc > 1 ? std::atoi(argv[1]) : 32;
+    const int ms    = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    ILIAS_NAMESPACE::PlatformContext platform;
+    McpServer<void> server(platform);
+    server.setCapabilities(ToolsCapability{});
+    server.registerToolFunction("work", std::function([](WorkParams params) -> ILIAS_NAMESPACE::IoTask<int> {
+                                    co_await ILIAS_NAMESPACE::sleep(std::chrono::milliseconds(params.ms));
+                                    co_return params.ms;
+                                }));
+    auto loopback = std::make_shared<Loopback>();
+    server.addTransport(LoopbackStream(loopback));
+
+    // Serial: the client waits for each response before sending the next call.
+    auto start = std::chrono::steady_clock::now();
+    for (int idx = 0; idx < calls; ++idx) {
+        push(*loopback, tool_call(idx, ms));
+        co_await wait_responses(*loopback, idx + 1);
+    }
+    auto serial = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Batch: one array, elements dispatched concurrently and answered in one reply.
+    std::string batch = "[";
+    for (int idx = 0; idx < calls; ++idx) {
+        batch.append(idx == 0 ? "" : ",").append(tool_call(calls + idx, ms));
+    }
+    batch.append(R"(,{"jsonrpc":"2.0","method":"notifications/cancelled","params":{"requestId":-1}}])");
+    loopback->responses.clear();
+    start = std::chrono::steady_clock::now();
+    push(*loopback, std::move(batch));
+    co_await wait_responses(*loopback, 1);
+    auto concurrent = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const bool ordered = loopback->responses.front().find(R"("id":)" + std::to_string(calls)) <
+                         loopback->responses.front().find(R"("id":)" + std::to_string(2 * calls - 1));
+    std::printf("%d calls of %d ms\n", calls, ms);
+    std::printf("%-12s %8.2f ms\n", "serial", serial);
+    std::printf("%-12s %8.2f ms (%zu reply, in order: %s)\n", "batch", concurrent, loopback->responses.size(),
+                ordered ? "yes" : "no");
+
+    server.close();
+    co_return ordered ? 0 : 1;
+}
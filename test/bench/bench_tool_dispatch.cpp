@@ -0,0 +1,78 @@
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ccmcp/server/tool_dispatch.hpp"
+
+CCMCP_USE_NAMESPACE
+
+struct Handler {
+    int id;
+};
+
+constexpr std::string_view kStaticNames[] = {"add", "mult", "div", "sub", "echo", "hello_unicode"};
+static_assert(detail::PerfectHashIndex(kStaticNames).find("div") == 2, "perfect hash must be usable at compile time");
+static_assert(detail::PerfectHashIndex(kStaticNames).find("missing") == detail::PerfectHashIndex::npos);
+
+template <typename FuncT>
+auto bench(const char* name, const std::vector<std::string>& queries, int rounds, FuncT&& lookup) -> bool {
+    long long checksum = 0;
+    auto start         = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& query : queries) {
+            checksum += lookup(std::string_view(query));
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-28s %8.2f ns/lookup (checksum %lld)\n", name, elapsed / (double(rounds) * queries.size()), checksum);
+    long long expected = 0;
+    for (std::size_t idx = 0; idx < queries.size(); ++idx) {
+        expected += static_cast<long long>(idx);
+    }
+    return checksum == expected * rounds;
+}
+
+int main(int argc, char** argv) {
+    const int toolCount = argc > 1 ? std::atoi(argv[1]) : 512;
+    const int rounds    = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    std::vector<std::string> names;
+    for (int idx = 0; idx < toolCount; ++idx) {
+        names.push_back("workspace_tool_" + std::to_string(idx * 7919) + "_query");
+    }
+    std::vector<std::string_view> views(names.begin(), names.end());
+
+    std::map<std::string_view, std::unique_ptr<Handler>> treeMap;
+    std::unordered_map<std::string, std::unique_ptr<Handler>> hashMap;
+    detail::FlatToolMap<std::unique_ptr<Handler>> flatMap;
+    std::vector<std::shared_ptr<Handler>> staticHandlers;
+    for (int idx = 0; idx < toolCount; ++idx) {
+        treeMap[views[idx]] = std::make_unique<Handler>(idx);
+        hashMap[names[idx]] = std::make_unique<Handler>(idx);
+        flatMap.insert(views[idx], std::make_unique<Handler>(idx));
+        staticHandlers.push_back(std::make_shared<Handler>(idx));
+    }
+    detail::ToolDispatchTable<Handler> table;
+    if (!table.setStatic(views, std::move(staticHandlers))) {
+        std::printf("perfect hash build failed\n");
+        return 1;
+    }
+
+    bool ok = true;
+    ok &= bench("std::map<string_view>", names, rounds,
+                [&](std::string_view name) { return treeMap.find(name)->second->id; });
+    ok &= bench("std::unordered_map<string>", names, rounds,
+                [&](std::string_view name) { return hashMap.find(std::string(name))->second->id; });
+    ok &= bench("FlatToolMap", names, rounds, [&](std::string_view name) { return (*flatMap.find(name))->id; });
+    ok &= bench("ToolDispatchTable (static)", names, rounds, [&](std::string_view name) { return table.find(name)->id; });
+    if (!ok) {
+        std::printf("lookup mismatch\n");
+        return 1;
+    }
+    return 0;
+}
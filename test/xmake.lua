@@ -21,6 +21,7 @@ for _, file in ipairs(os.files("./**/test_*.cpp")) do
     -- Otherwise, create a target for this file, in most case, it should enough
     target(name)
         add_includedirs("$(projectdir)/include")
+        add_deps("coro-cpp-mcp")
         set_kind("binary")
         set_default(false)
         set_encodings("utf-8")
@@ -42,4 +43,16 @@ for _, file in ipairs(os.files("./**/test_*.cpp")) do
 
     ::continue::
 
-end
\ No newline at end of file
+end
+-- Benchmarks are plain binaries, run them by hand with `xmake run <name>`
+for _, file in ipairs(os.files("./bench/bench_*.cpp")) do
+    local name = path.basename(file)
+    target(name)
+        set_kind("binary")
+        set_default(false)
+        set_group("bench")
+        set_encodings("utf-8")
+        add_deps("coro-cpp-mcp")
+        add_files(file)
+    target_end()
+end